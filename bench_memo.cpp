@@ -0,0 +1,8 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#include "bench_memo.hpp"
+
+static_assert(vir::memo_v<&sieve>[97] and not vir::memo_v<&sieve>[91]);
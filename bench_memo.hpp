@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+// A BENCH_MEMO byte sieve table, for make bench-memo.
+
+#include <vir/cw_memo.hpp>
+
+#include <array>
+
+#ifndef BENCH_MEMO
+#define BENCH_MEMO 262144
+#endif
+
+constexpr std::array<bool, BENCH_MEMO>
+sieve()
+{
+  std::array<bool, BENCH_MEMO> r = {};
+  for (unsigned i = 2; i < r.size(); ++i)
+    r[i] = true;
+  for (unsigned i = 2; i * i < r.size(); ++i)
+    if (r[i])
+      for (unsigned j = i * i; j < r.size(); j += i)
+        r[j] = false;
+  return r;
+}
+
+#if __has_include("bench_memo_table.hpp")
+#include "bench_memo_table.hpp"
+#endif
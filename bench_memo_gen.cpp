@@ -0,0 +1,14 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+// Writes bench_memo_table.hpp (see make bench-memo).
+
+#include "bench_memo.hpp"
+
+#include <iostream>
+
+int
+main()
+{ std::cout << vir::memo_specialization<&sieve>("&sieve"); }
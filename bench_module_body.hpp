@@ -0,0 +1,19 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+// The code of the bench-module TUs, after the #include or import of constexpr_wrapper.
+
+using namespace std::literals;
+
+template <std::constexpr_value<int> N>
+  int
+  scale(int x, N n)
+  { return x * n; }
+
+int
+f(int x)
+{ return scale(x, 8cw) + scale(x, std::cw<3>) + (x % std::cw<16>); }
+
+static_assert(std::cw<3> + std::cw<4> == std::cw<7>);
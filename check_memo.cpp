@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+// Compiles the specializations generated by check_memo_gen and compares them against the
+// constants (see make check-memo).
+
+#include "check_memo.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+template <typename T>
+  constexpr bool
+  same(const T& a, const T& b)
+  {
+    if constexpr (std::is_floating_point_v<T>)
+      return a == b ? __builtin_signbit(a) == __builtin_signbit(b) : a != a and b != b;
+    else if constexpr (std::is_enum_v<T>)
+      return a == b;
+    else
+      {
+        for (std::size_t i = 0; i < a.size(); ++i)
+          if (not same(a[i], b[i]))
+            return false;
+        return true;
+      }
+  }
+
+static_assert(same(vir::memo_v<&memo_enums>, memo_enums_v));
+static_assert(same(vir::memo_v<&memo_floats<float>>, memo_floats_v<float>));
+static_assert(same(vir::memo_v<&memo_floats<double>>, memo_floats_v<double>));
+static_assert(same(vir::memo_v<&memo_floats<long double>>, memo_floats_v<long double>));
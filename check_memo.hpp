@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+// Tables for make check-memo: functions that are not constexpr (so the tables can only come from
+// the generated specializations) and the expected values as constants.
+
+#include <vir/cw_memo.hpp>
+
+#include <array>
+#include <limits>
+
+enum class memo_e : short { lo = -32768, hi = 32767, x = 7 };
+
+constexpr std::array<memo_e, 4> memo_enums_v = {memo_e::lo, memo_e::hi, memo_e::x, memo_e(-1)};
+
+std::array<memo_e, 4>
+memo_enums()
+{ return memo_enums_v; }
+
+template <typename T>
+  using lim = std::numeric_limits<T>;
+
+// extreme, denormal, negative zero, infinite, and NaN values
+template <typename T>
+  constexpr std::array<std::array<T, 4>, 2> memo_floats_v = {{
+    {T(1) / 3, -T(0.1), -T(0), lim<T>::max()},
+    {lim<T>::denorm_min(), -lim<T>::min(), -lim<T>::infinity(), lim<T>::quiet_NaN()}}};
+
+template <typename T>
+  std::array<std::array<T, 4>, 2>
+  memo_floats()
+  { return memo_floats_v<T>; }
+
+#if __has_include("check_memo_table.hpp")
+#include "check_memo_table.hpp"
+#endif
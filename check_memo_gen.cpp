@@ -0,0 +1,19 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+// Writes check_memo_table.hpp (see make check-memo).
+
+#include "check_memo.hpp"
+
+#include <iostream>
+
+int
+main()
+{
+  std::cout << vir::memo_specialization<&memo_enums>("&memo_enums")
+            << vir::memo_specialization<&memo_floats<float>>("&memo_floats<float>")
+            << vir::memo_specialization<&memo_floats<double>>("&memo_floats<double>")
+            << vir::memo_specialization<&memo_floats<long double>>("&memo_floats<long double>");
+}
@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+// The named module vir.constexpr_wrapper, exporting everything <constexpr_wrapper.hpp> declares
+// (including the literals). Build with `make module`, then
+//   import vir.constexpr_wrapper;
+// in place of the #include. The std headers go into the global module fragment, so that the
+// module does not attach them (importers may still include them).
+//
+// Limitation: a TU that imports the module cannot also include <constexpr_wrapper.hpp>, and thus
+// none of the vir/cw_*.hpp headers (they all include it). The declarations are exported from an
+// extern "C++" block, which per the standard attaches them to the global module, so that they
+// would be the same entities as those of the header. But GCC (as of 12) attaches them to the
+// module anyway, and every use of std::cw etc. is then ambiguous. Use the module in TUs that only
+// need the wrapper itself.
+
+module;
+
+#include <compare>
+#include <concepts>
+#include <type_traits>
+
+export module vir.constexpr_wrapper;
+
+export extern "C++"
+{
+#include "constexpr_wrapper.hpp"
+}
+
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -6,17 +6,23 @@
 #ifndef VIR_CONSTEXPR_WRAPPER_HPP_
 #define VIR_CONSTEXPR_WRAPPER_HPP_
 
-#include <algorithm>
-#include <array>
+// Only what the wrapper itself needs: <limits>, <utility>, and <memory> are avoided (see `make
+// bench-includes`), which is why the code below uses static_cast<T&&> instead of std::forward and
+// __builtin_addressof instead of std::addressof.
+#include <compare>
 #include <concepts>
-#include <limits>
 #include <type_traits>
-#include <utility>
 
 namespace std
 {
-  template <auto _Xp, typename = std::remove_cvref_t<decltype(_Xp)>>
-    struct constexpr_wrapper;
+  // Declared in the namespace of its operators (see __detail::__cw_operators).
+  namespace __detail::__cw_operators
+  {
+    template <auto _Xp, typename = std::remove_cvref_t<decltype(_Xp)>>
+      struct constexpr_wrapper;
+  }
+
+  using __detail::__cw_operators::constexpr_wrapper;
 
   // *** constexpr_value<T, U = void> ***
   // If U is given, T must be convertible to U (`constexpr_value<int> auto` is analogous to `int`).
@@ -31,272 +37,475 @@ namespace std
   namespace __detail
   {
     // exposition-only
-    // Note: `not __any_constexpr_wrapper` is not equivalent to `not derived_from<T,
-    // constexpr_wrapper<T::value>>` because of SFINAE (i.e. SFINAE would be reversed)
+    // A positive integral power-of-two constant.
     template <typename _Tp>
-      concept __any_constexpr_wrapper = derived_from<_Tp, constexpr_wrapper<_Tp::value>>;
+      concept __cw_pow2 = constexpr_value<_Tp> and integral<typename _Tp::value_type>
+			    and not same_as<typename _Tp::value_type, bool>
+			    and (_Tp::value > 0) and (_Tp::value & (_Tp::value - 1)) == 0;
 
     // exposition-only
-    // Concept that enables declaring a single binary operator overload per operation:
-    // 1. LHS is derived from This, then RHS is either also derived from This (and there's only a
-    //    single candidate) or RHS is not a constexpr_wrapper (LHS provides the only operator
-    //    candidate).
-    // 2. LHS is not a constexpr_wrapper, then RHS is derived from This (RHS provides the only
-    //    operator candidate).
-    template <typename _Tp, typename _This>
-      concept __lhs_constexpr_wrapper
-	= constexpr_value<_Tp> and (derived_from<_Tp, _This> or not __any_constexpr_wrapper<_Tp>);
-  }
-
-  // Prefer to use `constexpr_value<type> auto` instead of `template <typename T> void
-  // f(constexpr_wrapper<T, type> ...` to constrain the type of the constant.
-  template <auto _Xp, typename _Tp>
-    struct constexpr_wrapper
-    {
-      using value_type = _Tp;
+    // Runtime operand of the mixed operators with a power-of-two constant: built-in integers and
+    // class types that behave like an integer with (closed) shift, bitwise and, additive, and
+    // ordering operators, such as 128/256-bit integer types.
+    template <typename _Tp, typename _Cp>
+      concept __cw_shiftable
+	= not constexpr_value<_Tp>
+	    and (integral<_Tp>
+		   or (is_class_v<_Tp> and constructible_from<_Tp, typename _Cp::value_type>
+			 and requires(const _Tp& __x, int __k) {
+			   { __x << __k } -> convertible_to<_Tp>;
+			   { __x >> __k } -> convertible_to<_Tp>;
+			   { __x & __x } -> convertible_to<_Tp>;
+			   { __x + __x } -> convertible_to<_Tp>;
+			   { __x - __x } -> convertible_to<_Tp>;
+			   { __x < __x } -> convertible_to<bool>;
+			 }));
 
-      using type = constexpr_wrapper;
+    // exposition-only
+    // Result type of `x @ c`: the usual arithmetic conversions for built-in integers, the class
+    // type otherwise.
+    template <typename _Tp, typename _Vp>
+      struct __cw_pow2_result
+      { using type = _Tp; };
 
-      static constexpr value_type value{ _Xp };
+    template <integral _Tp, typename _Vp>
+      struct __cw_pow2_result<_Tp, _Vp>
+      { using type = decltype(_Tp() * _Vp()); };
 
-      constexpr
-      operator value_type() const
-      { return _Xp; }
+    template <typename _Tp, typename _Cp>
+      using __cw_pow2_result_t = typename __cw_pow2_result<_Tp, typename _Cp::value_type>::type;
 
-      // overloads the following:
-      //
-      // unary:
-      // + - ~ ! & * ++ -- ->
-      //
-      // binary:
-      // + - * / % & | ^ && || , << >> == != < <= > >= ->* = += -= *= /= %= &= |= ^= <<= >>=
-      //
-      // [] and () are overloaded for constexpr_value or not constexpr_value, the latter not
-      // wrapping the result in constexpr_wrapper
+    // exposition-only
+    template <typename _Tp>
+      consteval int
+      __cw_log2(_Tp __x)
+      {
+	int __k = 0;
+	while (__x > 1)
+	  {
+	    __x /= 2;
+	    ++__k;
+	  }
+	return __k;
+      }
 
-      // The overload of -> is inconsistent because it cannot wrap its return value in a
-      // constexpr_wrapper. The compiler/standard requires a pointer type (not a pointer type
-      // wrapped in constexpr_wrapper). However, -> can work if it unwraps. The utility is
-      // questionable, which is why it may be interesting to "dereference" the wrapper to its
-      // value if _Tp doesn't implement operator->.
-      constexpr const auto*
-      operator->() const
+    // exposition-only
+    // Class types are known to be unsigned if 0 - 1 > 0 is a constant expression that is true.
+    // Otherwise they are treated as signed, which is correct either way.
+    template <typename _Tp>
+      consteval bool
+      __cw_is_unsigned()
       {
-	if constexpr (requires{_Xp.operator->();})
-	  return _Xp.operator->();
+	if constexpr (integral<_Tp>)
+	  return is_unsigned_v<_Tp>;
+	else if constexpr (requires { typename bool_constant<(_Tp(0) < _Tp(_Tp(0) - _Tp(1)))>; })
+	  return _Tp(0) < _Tp(_Tp(0) - _Tp(1));
 	else
-	  return std::addressof(_Xp);
+	  return false;
       }
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<+_Yp>
-	operator+() const
-	{ return {}; }
-
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<-_Yp>
-	operator-() const
-	{ return {}; }
-
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<~_Yp>
-	operator~() const
-	{ return {}; }
+    // exposition-only
+    // x / 2^k, rounded toward zero. A negative dividend needs a bias of 2^k - 1 before the
+    // (arithmetic) shift.
+    template <typename _Rp, typename _Cp>
+      constexpr _Rp
+      __cw_pow2_div(const _Rp& __x)
+      {
+	constexpr int __k = __cw_log2(_Cp::value);
+	if constexpr (__cw_is_unsigned<_Rp>())
+	  return _Rp(__x >> __k);
+	else if constexpr (integral<_Rp>)
+	  // all ones for negative __x (arithmetic shift), masked to the bias
+	  return (__x + ((__x >> (sizeof(_Rp) * __CHAR_BIT__ - 1)) & _Rp(_Cp::value - 1))) >> __k;
+	else
+	  return _Rp((__x < _Rp(0) ? _Rp(__x + _Rp(_Cp::value - 1)) : __x) >> __k);
+      }
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<!_Yp>
-	operator!() const
-	{ return {}; }
+    // not constexpr: calling it in a constant expression is the diagnostic
+    void
+    __cw_ordering_compared_to_nonzero();
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<&_Yp>
-	operator&() const
-	{ return {}; }
+    // exposition-only
+    // The 0 operand of comparisons with __cw_ordering. Unlike the standard comparison categories,
+    // it is not restricted to the literal 0, so that `(a <=> b) < std::cw<0>` works. Any other
+    // constant is an error and non-constant arguments are ill-formed.
+    struct __cw_zero
+    {
+      consteval
+      __cw_zero(int __z)
+      {
+	if (__z != 0)
+	  __cw_ordering_compared_to_nonzero();
+      }
+    };
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<*_Yp>
-	operator*() const
-	{ return {}; }
+    // exposition-only
+    // Structural representation of a value of the comparison category _Cat (strong_ordering,
+    // weak_ordering, or partial_ordering), which are not structural themselves. This makes the
+    // result of operator<=> on two constexpr_values a constexpr_wrapper. It converts to _Cat and
+    // supports the comparisons of _Cat with 0 and with the _Cat constants:
+    //   static_assert((std::cw<1> <=> std::cw<2>) < 0);
+    //   check<true>((std::cw<1> <=> std::cw<2>) == std::cw<0>);
+    template <typename _Cat>
+      struct __cw_ordering
+      {
+	// -1: less, 0: equal/equivalent, 1: greater, 2: unordered
+	signed char _M_value;
+
+	constexpr
+	__cw_ordering(_Cat __c)
+	: _M_value(__c < 0 ? -1 : __c > 0 ? 1 : __c == 0 ? 0 : 2)
+	{}
+
+	constexpr
+	operator _Cat() const
+	{
+	  if constexpr (same_as<_Cat, partial_ordering>)
+	    if (_M_value == 2)
+	      return partial_ordering::unordered;
+	  return _M_value < 0 ? _Cat::less : _M_value > 0 ? _Cat::greater : _Cat::equivalent;
+	}
+
+	friend constexpr bool
+	operator==(const __cw_ordering&, const __cw_ordering&) = default;
+
+	friend constexpr bool
+	operator==(__cw_ordering __a, _Cat __b)
+	{ return _Cat(__a) == __b; }
+
+	// <, <=, >, >= (in both orders) are rewritten in terms of <=>
+	friend constexpr bool
+	operator==(__cw_ordering __a, __cw_zero)
+	{ return __a._M_value == 0; }
+
+	friend constexpr _Cat
+	operator<=>(__cw_ordering __a, __cw_zero)
+	{ return _Cat(__a); }
+      };
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<++_Yp>
-	operator++() const
-	{ return {}; }
+    // exposition-only
+    // The structural equivalent of the result of operator<=>. User-defined operator<=> returning
+    // another (structural) type are not modified.
+    template <typename _Tp>
+      constexpr _Tp
+      __cw_structural_ordering(_Tp __x)
+      { return __x; }
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<_Yp++>
-	operator++(int) const
-	{ return {}; }
+    constexpr __cw_ordering<strong_ordering>
+    __cw_structural_ordering(strong_ordering __x)
+    { return __x; }
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<--_Yp>
-	operator--() const
-	{ return {}; }
+    constexpr __cw_ordering<weak_ordering>
+    __cw_structural_ordering(weak_ordering __x)
+    { return __x; }
 
-      template <auto _Yp = _Xp>
-	constexpr constexpr_wrapper<_Yp-->
-	operator--(int) const
-	{ return {}; }
+    constexpr __cw_ordering<partial_ordering>
+    __cw_structural_ordering(partial_ordering __x)
+    { return __x; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value + _Bp::value>
+    // exposition-only
+    // The namespace of constexpr_wrapper, which contains nothing but constexpr_wrapper and the
+    // binary operators. Thus the operators are declared exactly once and are found via ADL
+    // whenever one of the operands is a constexpr_wrapper (or derived from one), and there is
+    // always only a single candidate per operation. Declaring them as hidden friends of
+    // constexpr_wrapper itself adds another overload per operator and specialization, which makes
+    // front-end time grow quadratically with the number of distinct constants in a TU. Hidden
+    // friends of a common (empty) base class would avoid that, but two subobjects of the same
+    // empty type cannot share an address, so e.g. a tuple of distinct constants would not be
+    // empty anymore.
+    namespace __cw_operators
+    {
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value + _Bp::value>
 	operator+(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value - _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value - _Bp::value>
 	operator-(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value * _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value * _Bp::value>
 	operator*(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value / _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value / _Bp::value>
 	operator/(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value % _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value % _Bp::value>
 	operator%(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value & _Bp::value>
+      // Mixed operations of a runtime integer and a power-of-two constant are implemented as
+      // shifts and masks. Compilers do this for built-in integers anyway, but not for user-defined
+      // wide integers, where `x % cw<4096>` would otherwise be a full software division. Signed
+      // division and remainder round toward zero, like the built-in operators.
+      template <typename _Tp, __cw_pow2 _Bp>
+	requires __cw_shiftable<_Tp, _Bp>
+	constexpr __cw_pow2_result_t<_Tp, _Bp>
+	operator*(const _Tp& __x, _Bp)
+	{
+	  using _Rp = __cw_pow2_result_t<_Tp, _Bp>;
+	  return _Rp(_Rp(__x) << __cw_log2(_Bp::value));
+	}
+
+      template <__cw_pow2 _Ap, typename _Tp>
+	requires __cw_shiftable<_Tp, _Ap>
+	constexpr __cw_pow2_result_t<_Tp, _Ap>
+	operator*(_Ap __a, const _Tp& __x)
+	{ return __x * __a; }
+
+      template <typename _Tp, __cw_pow2 _Bp>
+	requires __cw_shiftable<_Tp, _Bp>
+	constexpr __cw_pow2_result_t<_Tp, _Bp>
+	operator/(const _Tp& __x, _Bp)
+	{ return __cw_pow2_div<__cw_pow2_result_t<_Tp, _Bp>, _Bp>(__x); }
+
+      template <typename _Tp, __cw_pow2 _Bp>
+	requires __cw_shiftable<_Tp, _Bp>
+	constexpr __cw_pow2_result_t<_Tp, _Bp>
+	operator%(const _Tp& __x, _Bp)
+	{
+	  using _Rp = __cw_pow2_result_t<_Tp, _Bp>;
+	  if constexpr (__cw_is_unsigned<_Rp>())
+	    return _Rp(_Rp(__x) & _Rp(_Bp::value - 1));
+	  else
+	    return _Rp(_Rp(__x) - _Rp(__cw_pow2_div<_Rp, _Bp>(__x) << __cw_log2(_Bp::value)));
+	}
+
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value & _Bp::value>
 	operator&(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value | _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value | _Bp::value>
 	operator|(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value ^ _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value ^ _Bp::value>
 	operator^(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value && _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value && _Bp::value>
 	operator&&(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<_Ap::value || _Bp::value>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<_Ap::value || _Bp::value>
 	operator||(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value , _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value , _Bp::value)>
 	operator,(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value << _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value << _Bp::value)>
 	operator<<(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value >> _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value >> _Bp::value)>
 	operator>>(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value == _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value == _Bp::value)>
 	operator==(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value != _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value != _Bp::value)>
 	operator!=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value < _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value < _Bp::value)>
 	operator<(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value <= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value <= _Bp::value)>
 	operator<=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value > _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value > _Bp::value)>
 	operator>(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value >= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value >= _Bp::value)>
 	operator>=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value <=> _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<__cw_structural_ordering(_Ap::value <=> _Bp::value)>
 	operator<=>(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value ->* _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value ->* _Bp::value)>
 	operator->*(_Ap, _Bp)
 	{ return {}; }
 
-      template <constexpr_value _Ap>
-	constexpr constexpr_wrapper<(_Xp = _Ap::value)>
-	operator=(_Ap) const
-	{ return {}; }
-
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value += _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value += _Bp::value)>
 	operator+=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value -= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value -= _Bp::value)>
 	operator-=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value *= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value *= _Bp::value)>
 	operator*=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value /= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value /= _Bp::value)>
 	operator/=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value %= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value %= _Bp::value)>
 	operator%=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value &= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value &= _Bp::value)>
 	operator&=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value |= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value |= _Bp::value)>
 	operator|=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value ^= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value ^= _Bp::value)>
 	operator^=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value <<= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value <<= _Bp::value)>
 	operator<<=(_Ap, _Bp)
 	{ return {}; }
 
-      template <__detail::__lhs_constexpr_wrapper<constexpr_wrapper> _Ap, constexpr_value _Bp>
-	friend constexpr constexpr_wrapper<(_Ap::value >>= _Bp::value)>
+      template <constexpr_value _Ap, constexpr_value _Bp>
+	constexpr constexpr_wrapper<(_Ap::value >>= _Bp::value)>
 	operator>>=(_Ap, _Bp)
 	{ return {}; }
+    }
+  }
+
+  // Prefer to use `constexpr_value<type> auto` instead of `template <typename T> void
+  // f(constexpr_wrapper<T, type> ...` to constrain the type of the constant.
+  template <auto _Xp, typename _Tp>
+    struct __detail::__cw_operators::constexpr_wrapper
+    {
+      using value_type = _Tp;
+
+      using type = constexpr_wrapper;
+
+      // Spelled with _Tp rather than value_type: GCC creates a new variant of _Tp for every
+      // `const value_type` and then scans all of them, i.e. quadratic in the number of
+      // specializations.
+      static constexpr _Tp value{ _Xp };
+
+      constexpr
+      operator _Tp() const
+      { return _Xp; }
+
+      // overloads the following:
+      //
+      // unary:
+      // + - ~ ! & * ++ -- ->
+      //
+      // binary:
+      // + - * / % & | ^ && || , << >> == != < <= > >= ->* = += -= *= /= %= &= |= ^= <<= >>=
+      //
+      // [] and () are overloaded for constexpr_value or not constexpr_value, the latter not
+      // wrapping the result in constexpr_wrapper
+
+      // The overload of -> is inconsistent because it cannot wrap its return value in a
+      // constexpr_wrapper. The compiler/standard requires a pointer type (not a pointer type
+      // wrapped in constexpr_wrapper). However, -> can work if it unwraps. The utility is
+      // questionable, which is why it may be interesting to "dereference" the wrapper to its
+      // value if _Tp doesn't implement operator->.
+      constexpr const auto*
+      operator->() const
+      {
+	if constexpr (requires{_Xp.operator->();})
+	  return _Xp.operator->();
+	else
+	  return __builtin_addressof(_Xp);  // std::addressof needs <memory>
+      }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<+_Yp>
+	operator+() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<-_Yp>
+	operator-() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<~_Yp>
+	operator~() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<!_Yp>
+	operator!() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<&_Yp>
+	operator&() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<*_Yp>
+	operator*() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<++_Yp>
+	operator++() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<_Yp++>
+	operator++(int) const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<--_Yp>
+	operator--() const
+	{ return {}; }
+
+      template <auto _Yp = _Xp>
+	constexpr constexpr_wrapper<_Yp-->
+	operator--(int) const
+	{ return {}; }
+
+      template <constexpr_value _Ap>
+	constexpr constexpr_wrapper<(_Xp = _Ap::value)>
+	operator=(_Ap) const
+	{ return {}; }
 
 #if defined __cpp_static_call_operator && __cplusplus > 202002L
 #define _STATIC static
@@ -317,7 +526,7 @@ namespace std
 	requires (not constexpr_value<std::remove_cvref_t<_Args>> || ...)
 	_STATIC constexpr decltype(value(std::declval<_Args>()...))
 	operator()(_Args&&... __args) _CONST
-	{ return value(std::forward<_Args>(__args)...); }
+	{ return value(static_cast<_Args&&>(__args)...); }
 
       _STATIC constexpr _Tp
       operator()() _CONST
@@ -335,7 +544,7 @@ namespace std
 	requires (not constexpr_value<std::remove_cvref_t<_Args>> || ...)
 	_STATIC constexpr decltype(value[std::declval<_Args>()...])
 	operator[](_Args&&... __args) _CONST
-	{ return value[std::forward<_Args>(__args)...]; }
+	{ return value[static_cast<_Args&&>(__args)...]; }
 #else
       template <constexpr_value _Arg>
 	_STATIC constexpr constexpr_wrapper<value[_Arg::value]>
@@ -346,7 +555,7 @@ namespace std
         requires (not constexpr_value<std::remove_cvref_t<_Arg>>)
 	_STATIC constexpr decltype(value[std::declval<_Arg>()])
         operator[](_Arg&& _arg) _CONST
-        { return value[std::forward<_Arg>(_arg)]; }
+        { return value[static_cast<_Arg&&>(_arg)]; }
 #endif
 
 #undef _STATIC
@@ -357,90 +566,156 @@ namespace std
   template <auto _Xp>
     inline constexpr constexpr_wrapper<_Xp> cw{};
 
-#if __cpp_lib_constexpr_charconv >= 202207L && __cplusplus > 202002L
+#if __cplusplus > 202002L
   namespace __detail
   {
+    // exposition-only
+    // Result of scanning the characters of a constexpr_wrapper literal.
+    struct __cw_literal
+    {
+      unsigned long long _M_value = 0;
+      bool _M_valid = true;
+      bool _M_overflow = false;
+    };
+
+    // A single pass over the characters of the literal. The prefix (0, 0x, 0X, 0b, 0B) determines
+    // the base; digit separators are skipped. This is intentionally not a template: the loop is
+    // parsed once and only evaluated per literal, which is considerably cheaper than instantiating
+    // a fold over the character pack for every distinct literal.
+    consteval __cw_literal
+    __cw_scan(const char* __s, int __n, bool __hex_suffix)
+    {
+      __cw_literal __lit = {};
+      unsigned __base = 10;
+      int __i = 0;
+      if (__n > 1 and __s[0] == '0')
+	{
+	  if (__s[1] == 'x' or __s[1] == 'X')
+	    {
+	      __base = 16;
+	      __i = 2;
+	      // hexadecimal literals swallow the 'c'/'C' of the "cw"/"CW" suffix
+	      if (__hex_suffix)
+		--__n;
+	    }
+	  else if (__s[1] == 'b' or __s[1] == 'B')
+	    {
+	      __base = 2;
+	      __i = 2;
+	    }
+	  else
+	    {
+	      __base = 8;
+	      __i = 1;
+	    }
+	}
+      constexpr auto __max = ~0ull;
+      for (; __i < __n; ++__i)
+	{
+	  const char __c = __s[__i];
+	  if (__c == '\'')
+	    continue;
+	  unsigned __digit = 16;
+	  if (__c >= '0' and __c <= '9')
+	    __digit = __c - '0';
+	  else if (__c >= 'a' and __c <= 'f')
+	    __digit = __c - 'a' + 10;
+	  else if (__c >= 'A' and __c <= 'F')
+	    __digit = __c - 'A' + 10;
+	  if (__digit >= __base)
+	    {
+	      __lit._M_valid = false;
+	      break;
+	    }
+	  if (__lit._M_value > (__max - __digit) / __base)
+	    __lit._M_overflow = true;
+	  __lit._M_value = __lit._M_value * __base + __digit;
+	}
+      return __lit;
+    }
+
+    // Selects the "w"/"W" literal operators for hexadecimal literals, where the 'c'/'C' of the
+    // suffix is lexed as a hex digit.
+    consteval bool
+    __cw_is_hex_with_suffix(const char* __s, int __n, char __suffix)
+    {
+      return __n > 2 and __s[0] == '0' and (__s[1] == 'x' or __s[1] == 'X')
+	       and __s[__n - 1] == __suffix;
+    }
+
     template <char... _Chars>
+      inline constexpr char __cw_chars[] = {_Chars...};
+
+    // numeric_limits<_Tp>::max() for signed integers, without <limits>
+    template <typename _Tp>
+      inline constexpr _Tp __cw_int_max = _Tp(make_unsigned_t<_Tp>(-1) >> 1);
+
+    // Keyed on the scan result (not the characters) so that different spellings of the same value
+    // share a single instantiation. Returns the narrowest signed type that can represent the
+    // value, unsigned long long otherwise.
+    template <__cw_literal _Lit>
       consteval auto
-      __cw_prepare_array()
+      __cw_narrowest()
       {
-	constexpr auto __not_digit_sep = [](char __c) { return __c != '\''; };
-	constexpr char __arr0[sizeof...(_Chars)] = {_Chars...};
-	constexpr auto __size
-	  = std::count_if(std::begin(__arr0), std::end(__arr0), __not_digit_sep);
-	std::array<char, __size> __tmp = {};
-	std::copy_if(std::begin(__arr0), std::end(__arr0), __tmp.begin(), __not_digit_sep);
-	return __tmp;
+	static_assert(_Lit._M_valid, "invalid characters in constexpr_wrapper literal");
+	static_assert(not _Lit._M_overflow, "constexpr_wrapper literal value out of range");
+	constexpr unsigned long long __x = _Lit._M_value;
+	if constexpr (__x <= __cw_int_max<signed char>)
+	  return static_cast<signed char>(__x);
+	else if constexpr (__x <= __cw_int_max<signed short>)
+	  return static_cast<signed short>(__x);
+	else if constexpr (__x <= __cw_int_max<signed int>)
+	  return static_cast<signed int>(__x);
+	else if constexpr (__x <= __cw_int_max<signed long>)
+	  return static_cast<signed long>(__x);
+	else if constexpr (__x <= __cw_int_max<signed long long>)
+	  return static_cast<signed long long>(__x);
+	else
+	  return __x;
+      }
+
+    // Same as above, but for the negated value: the result is the narrowest signed type that can
+    // represent -value. This covers the full range of the signed types, down to
+    // numeric_limits<long long>::min().
+    template <__cw_literal _Lit>
+      consteval auto
+      __cw_narrowest_negated()
+      {
+	static_assert(_Lit._M_valid, "invalid characters in constexpr_wrapper literal");
+	static_assert(not _Lit._M_overflow
+			and _Lit._M_value <= __cw_int_max<signed long long> + 1ull,
+		      "constexpr_wrapper literal value out of range");
+	constexpr unsigned long long __x = _Lit._M_value;
+	// -(x - 1) - 1 avoids overflow for the minimum value of the type
+	if constexpr (__x == 0)
+	  return static_cast<signed char>(0);
+	else if constexpr (__x - 1 <= __cw_int_max<signed char>)
+	  return static_cast<signed char>(-static_cast<signed char>(__x - 1) - 1);
+	else if constexpr (__x - 1 <= __cw_int_max<signed short>)
+	  return static_cast<signed short>(-static_cast<signed short>(__x - 1) - 1);
+	else if constexpr (__x - 1 <= __cw_int_max<signed int>)
+	  return -static_cast<signed int>(__x - 1) - 1;
+	else if constexpr (__x - 1 <= __cw_int_max<signed long>)
+	  return -static_cast<signed long>(__x - 1) - 1;
+	else
+	  return -static_cast<signed long long>(__x - 1) - 1;
       }
 
     template <char... _Chars>
       consteval auto
       __cw_parse()
+      { return __cw_narrowest<__cw_scan(__cw_chars<_Chars...>, sizeof...(_Chars), true)>(); }
+
+    template <char... _Chars>
+      consteval auto
+      __cw_parse_negated()
       {
-	constexpr std::array __arr = __cw_prepare_array<_Chars...>();
-	constexpr int __base = __arr[0] == '0' and 2 < __arr.size()
-				 ? __arr[1] == 'x' or __arr[1] == 'X' ? 16
-								      : __arr[1] == 'b' ? 2 : 8
-				 : 10;
-        constexpr int __offset = __base == 10 ? 0 : __base == 8 ? 1 : 2;
-	constexpr auto __end = __arr.end() - (__base == 16 ? 1 : 0);
-        constexpr bool __valid_chars = std::all_of(__arr.begin() + __offset, __end, [=](char c) {
-                                       if constexpr (__base == 16)
-                                         return (c >= 'a' and c <= 'f') or (c >= 'A' and c <= 'F')
-                                                  or (c >= '0' and c <= '9');
-                                       else
-                                         return c >= '0' and c < char('0' + __base);
-                                     });
-        static_assert(__valid_chars, "invalid characters in constexpr_wrapper literal");
-
-        // common values, freeing values for error conditions
-        if constexpr (__arr == std::array {'0'})
-          return static_cast<signed char>(0);
-        else if constexpr (__arr == std::array {'1'})
-          return static_cast<signed char>(1);
-        else if constexpr (__arr == std::array {'2'})
-          return static_cast<signed char>(2);
-
-        constexpr unsigned long long __x = [&]() {
-          unsigned long long __x = {};
-          constexpr auto __max = std::numeric_limits<unsigned long long>::max();
-          auto __it = __arr.begin() + __offset;
-          for (; __it != __end; ++__it)
-            {
-              unsigned __nextdigit = *__it - '0';
-              if constexpr (__base == 16)
-                {
-                  if (*__it >= 'a')
-                    __nextdigit = *__it - 'a' + 10;
-                  else if (*__it >= 'A')
-                    __nextdigit = *__it - 'A' + 10;
-                }
-              if (__x > __max / __base)
-                return 0ull;
-              __x *= __base;
-              if (__x > __max - __nextdigit)
-                return 0ull;
-              __x += __nextdigit;
-            }
-          return __x;
-        }();
-        static_assert(__x != 0, "constexpr_wrapper literal value out of range");
-        if constexpr (__x <= std::numeric_limits<signed char>::max())
-          return static_cast<signed char>(__x);
-        else if constexpr (__x <= std::numeric_limits<signed short>::max())
-          return static_cast<signed short>(__x);
-        else if constexpr (__x <= std::numeric_limits<signed int>::max())
-          return static_cast<signed int>(__x);
-        else if constexpr (__x <= std::numeric_limits<signed long>::max())
-          return static_cast<signed long>(__x);
-        else if constexpr (__x <= std::numeric_limits<signed long long>::max())
-          return static_cast<signed long long>(__x);
-        else
-          return __x;
+	return __cw_narrowest_negated<__cw_scan(__cw_chars<_Chars...>, sizeof...(_Chars),
+						false)>();
       }
   }
 
-  namespace literals
+  inline namespace literals
   {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wliteral-suffix"
@@ -453,22 +728,29 @@ namespace std
       { return std::cw<std::__detail::__cw_parse<_Chars...>()>; }
 
     template <char... _Chars>
-      requires (sizeof...(_Chars) > 2
-		  and std::array {_Chars...}[0] == '0'
-		  and (std::array {_Chars...}[1] == 'x' or std::array {_Chars...}[1] == 'X')
-		  and std::array {_Chars...}.back() == 'c'
-	       )
+      requires (std::__detail::__cw_is_hex_with_suffix(std::__detail::__cw_chars<_Chars...>,
+							 sizeof...(_Chars), 'c'))
       constexpr auto operator"" w()
       { return std::cw<std::__detail::__cw_parse<_Chars...>()>; }
 
     template <char... _Chars>
-      requires (sizeof...(_Chars) > 2
-		  and std::array {_Chars...}[0] == '0'
-		  and (std::array {_Chars...}[1] == 'x' or std::array {_Chars...}[1] == 'X')
-		  and std::array {_Chars...}.back() == 'C'
-	       )
+      requires (std::__detail::__cw_is_hex_with_suffix(std::__detail::__cw_chars<_Chars...>,
+							 sizeof...(_Chars), 'C'))
       constexpr auto operator"" W()
       { return std::cw<std::__detail::__cw_parse<_Chars...>()>; }
+
+    // `-128cw` negates a `constexpr_wrapper<short(128)>`, which yields an int (integral promotion)
+    // and `-9223372036854775808cw` is not a signed value at all. The "ncw" literals produce the
+    // negated value directly, using the narrowest signed type: `128ncw` is
+    // `constexpr_wrapper<(signed char)-128>` and `9223372036854775808ncw` is
+    // `constexpr_wrapper<numeric_limits<long long>::min()>`.
+    template <char... _Chars>
+      constexpr auto operator"" ncw()
+      { return std::cw<std::__detail::__cw_parse_negated<_Chars...>()>; }
+
+    template <char... _Chars>
+      constexpr auto operator"" NCW()
+      { return std::cw<std::__detail::__cw_parse_negated<_Chars...>()>; }
 #pragma GCC diagnostic pop
   }
 #endif
@@ -0,0 +1,274 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_BITSET_HPP_
+#define VIR_CW_BITSET_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <utility>
+
+namespace vir
+{
+  // Fixed-size bit set. Unlike std::bitset, it is structural (and all its operations are
+  // constexpr), so it can be wrapped: `std::cw<b1> | std::cw<b2>` is a constexpr_wrapper of the
+  // union via the operators of constexpr_wrapper, and `std::cw<b>[std::cw<3>]` is a wrapped bool.
+  // A runtime set combined with a wrapped set uses the constant words as immediates:
+  //   constexpr auto admin = vir::make_bitset(std::cw<40uz>, std::cw<0>, std::cw<7>);
+  //   if (vir::intersects(user_perms, admin))  // a single `test` with 0x81 for 40 bits
+  //
+  // The bits past _Np in the last word are always zero.
+  template <std::size_t _Np>
+    struct bitset
+    {
+      using _Word = unsigned long long;
+
+      static constexpr std::size_t _S_word_bits = sizeof(_Word) * CHAR_BIT;
+
+      static constexpr std::size_t _S_words
+	= _Np == 0 ? 1 : (_Np + _S_word_bits - 1) / _S_word_bits;
+
+      // the valid bits of the last word (none for the single word of an empty bitset)
+      static constexpr _Word _S_tail_mask
+	= _Np == 0 ? _Word()
+	  : _Np % _S_word_bits == 0 ? ~_Word() : (_Word(1) << (_Np % _S_word_bits)) - 1;
+
+      _Word _M_words[_S_words] = {};
+
+      static constexpr std::constexpr_wrapper<_Np> size{};
+
+      constexpr bool
+      test(std::size_t __i) const
+      { return (_M_words[__i / _S_word_bits] >> (__i % _S_word_bits)) & 1; }
+
+      constexpr bool
+      operator[](std::size_t __i) const
+      { return test(__i); }
+
+      constexpr bitset&
+      set(std::size_t __i, bool __value = true)
+      {
+	const _Word __bit = _Word(1) << (__i % _S_word_bits);
+	_Word& __w = _M_words[__i / _S_word_bits];
+	__w = __value ? __w | __bit : __w & ~__bit;
+	return *this;
+      }
+
+      constexpr bitset&
+      reset(std::size_t __i)
+      { return set(__i, false); }
+
+      constexpr bitset&
+      flip(std::size_t __i)
+      {
+	_M_words[__i / _S_word_bits] ^= _Word(1) << (__i % _S_word_bits);
+	return *this;
+      }
+
+      // Number of set bits. The loop over the words is vectorized where the target has a vector
+      // popcount (e.g. AVX512-VPOPCNTDQ).
+      constexpr int
+      count() const
+      {
+	int __n = 0;
+	for (std::size_t __k = 0; __k < _S_words; ++__k)
+	  __n += std::popcount(_M_words[__k]);
+	return __n;
+      }
+
+      constexpr bool
+      any() const
+      {
+	_Word __r = 0;
+	for (std::size_t __k = 0; __k < _S_words; ++__k)
+	  __r |= _M_words[__k];
+	return __r != 0;
+      }
+
+      constexpr bool
+      none() const
+      { return not any(); }
+
+      constexpr bool
+      all() const
+      {
+	// no early exit: for a few words, and-ing them is cheaper than the branches
+	_Word __r = ~_Word();
+	for (std::size_t __k = 0; __k + 1 < _S_words; ++__k)
+	  __r &= _M_words[__k];
+	return (__r & (_M_words[_S_words - 1] | ~_S_tail_mask)) == ~_Word();
+      }
+
+      // Index of the first set bit at or after __from, or size if there is none.
+      constexpr std::size_t
+      find_next(std::size_t __from) const
+      {
+	if (__from >= _Np)
+	  return _Np;
+	std::size_t __k = __from / _S_word_bits;
+	_Word __w = _M_words[__k] & (~_Word() << (__from % _S_word_bits));
+	while (__w == 0)
+	  {
+	    if (++__k == _S_words)
+	      return _Np;
+	    __w = _M_words[__k];
+	  }
+	return __k * _S_word_bits + std::countr_zero(__w);
+      }
+
+      constexpr std::size_t
+      find_first() const
+      { return find_next(0); }
+
+      friend constexpr bool
+      operator==(const bitset&, const bitset&) = default;
+
+      friend constexpr bitset
+      operator&(const bitset& __a, const bitset& __b)
+      {
+	bitset __r;
+	for (std::size_t __k = 0; __k < _S_words; ++__k)
+	  __r._M_words[__k] = __a._M_words[__k] & __b._M_words[__k];
+	return __r;
+      }
+
+      friend constexpr bitset
+      operator|(const bitset& __a, const bitset& __b)
+      {
+	bitset __r;
+	for (std::size_t __k = 0; __k < _S_words; ++__k)
+	  __r._M_words[__k] = __a._M_words[__k] | __b._M_words[__k];
+	return __r;
+      }
+
+      friend constexpr bitset
+      operator^(const bitset& __a, const bitset& __b)
+      {
+	bitset __r;
+	for (std::size_t __k = 0; __k < _S_words; ++__k)
+	  __r._M_words[__k] = __a._M_words[__k] ^ __b._M_words[__k];
+	return __r;
+      }
+
+      friend constexpr bitset
+      operator~(const bitset& __a)
+      {
+	bitset __r;
+	for (std::size_t __k = 0; __k < _S_words; ++__k)
+	  __r._M_words[__k] = ~__a._M_words[__k];
+	__r._M_words[_S_words - 1] &= _S_tail_mask;
+	return __r;
+      }
+    };
+
+  // A bit set of the given size with the given bits set. If the size and all indices are
+  // constexpr_values, the result is a constexpr_wrapper of the bitset:
+  //   vir::make_bitset(std::cw<8uz>, std::cw<1>, std::cw<3>)  ->  cw<bitset<8>{0b1010}>
+  // Otherwise it is a runtime bitset.
+  template <std::constexpr_value<std::size_t> _Np, typename... _Is>
+    requires (std::convertible_to<_Is, std::size_t> and ...)
+    constexpr auto
+    make_bitset(_Np, _Is... __is)
+    {
+      if constexpr ((std::constexpr_value<_Is> and ...))
+	{
+	  static_assert(((std::in_range<std::size_t>(_Is::value)
+			  and std::size_t(_Is::value) < _Np::value) and ...),
+			"bit index out of range");
+	  return std::cw<[] {
+	    bitset<_Np::value> __r;
+	    (__r.set(std::size_t(_Is::value)), ...);
+	    return __r;
+	  }()>;
+	}
+      else
+	{
+	  bitset<_Np::value> __r;
+	  (__r.set(std::size_t(__is)), ...);
+	  return __r;
+	}
+    }
+
+  namespace __detail
+  {
+    // The bitset type of a bitset or of a constexpr_wrapper of a bitset.
+    template <typename _Tp>
+      struct __bitset_of
+      {};
+
+    template <std::size_t _Np>
+      struct __bitset_of<bitset<_Np>>
+      { using type = bitset<_Np>; };
+
+    template <std::constexpr_value _Tp>
+      requires requires { typename __bitset_of<typename _Tp::value_type>::type; }
+      struct __bitset_of<_Tp>
+      : __bitset_of<typename _Tp::value_type>
+      {};
+
+    template <typename _Ap, typename _Bp>
+      concept __bitset_pair
+	= std::same_as<typename __bitset_of<_Ap>::type, typename __bitset_of<_Bp>::type>;
+
+    // __f(__a, __b) as bitsets, wrapped if both are constexpr_values
+    template <typename _Ap, typename _Bp, typename _Fp>
+      constexpr auto
+      __bitset_query(const _Ap& __a, const _Bp& __b, _Fp __f)
+      {
+	using _Bs = typename __bitset_of<_Ap>::type;
+	if constexpr (std::constexpr_value<_Ap> and std::constexpr_value<_Bp>)
+	  return std::cw<__f(_Bs(_Ap::value), _Bs(_Bp::value))>;
+	else
+	  return __f(_Bs(__a), _Bs(__b));
+      }
+  }
+
+  // Whether __a and __b have a set bit in common. Either may be a wrapped bitset; if both are, the
+  // result is a wrapped bool.
+  template <typename _Ap, typename _Bp>
+    requires __detail::__bitset_pair<_Ap, _Bp>
+    constexpr auto
+    intersects(const _Ap& __a, const _Bp& __b)
+    {
+      return __detail::__bitset_query(__a, __b, [](const auto& __x, const auto& __y) {
+	       return (__x & __y).any();
+	     });
+    }
+
+  // Whether every bit of __a is also set in __b.
+  template <typename _Ap, typename _Bp>
+    requires __detail::__bitset_pair<_Ap, _Bp>
+    constexpr auto
+    is_subset_of(const _Ap& __a, const _Bp& __b)
+    {
+      return __detail::__bitset_query(__a, __b, [](const auto& __x, const auto& __y) {
+	       return (__x & ~__y).none();
+	     });
+    }
+
+  template <std::size_t _Np>
+    constexpr int
+    popcount(const bitset<_Np>& __a)
+    { return __a.count(); }
+
+  // Queries of wrapped bit sets, yielding constants.
+  template <std::constexpr_value _Bp>
+    requires requires { typename std::constexpr_wrapper<_Bp::value.count()>; }
+    constexpr auto
+    popcount(_Bp)
+    { return std::cw<_Bp::value.count()>; }
+
+  template <std::constexpr_value _Bp>
+    requires requires { typename std::constexpr_wrapper<_Bp::value.find_first()>; }
+    constexpr auto
+    find_first(_Bp)
+    { return std::cw<_Bp::value.find_first()>; }
+}
+
+#endif  // VIR_CW_BITSET_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
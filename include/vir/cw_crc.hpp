@@ -0,0 +1,421 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_CRC_HPP_
+#define VIR_CW_CRC_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <type_traits>
+
+#if defined __SSE4_2__ or (defined __PCLMUL__ and defined __SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace vir
+{
+  // A CRC in the parameterization of the CRC catalogues (Williams' model): polynomial without the
+  // leading term, initial register value, reflection of input and output (only refin == refout is
+  // supported, which covers all common CRCs), and final xor. Structural, so that the CRC functions
+  // below take it as a constant and build their tables at compile time:
+  //   constexpr auto crc16_modbus = std::cw<vir::crc_params{16, 0x8005, 0xffff, true, 0}>;
+  struct crc_params
+  {
+    int width;
+    std::uint64_t poly;
+    std::uint64_t init;
+    bool reflect;
+    std::uint64_t xorout;
+
+    friend constexpr bool
+    operator==(const crc_params&, const crc_params&) = default;
+  };
+
+  // CRC-32 (ISO-HDLC: Ethernet, zlib, PNG)
+  inline constexpr std::constexpr_wrapper<crc_params{32, 0x04c11db7, 0xffffffff, true,
+						     0xffffffff}> crc32{};
+
+  // CRC-32C (Castagnoli: iSCSI, SCTP, ext4)
+  inline constexpr std::constexpr_wrapper<crc_params{32, 0x1edc6f41, 0xffffffff, true,
+						     0xffffffff}> crc32c{};
+
+  // CRC-64/XZ
+  inline constexpr std::constexpr_wrapper<crc_params{64, 0x42f0e1eba9ea3693, ~0ull, true,
+						     ~0ull}> crc64_xz{};
+
+  // CRC-64/ECMA-182
+  inline constexpr std::constexpr_wrapper<crc_params{64, 0x42f0e1eba9ea3693, 0, false, 0}>
+    crc64_ecma{};
+
+  // CRC-16/IBM-3740 (a.k.a. CRC-16/CCITT-FALSE)
+  inline constexpr std::constexpr_wrapper<crc_params{16, 0x1021, 0xffff, false, 0}> crc16_ccitt{};
+
+  // CRC-16/ARC
+  inline constexpr std::constexpr_wrapper<crc_params{16, 0x8005, 0, true, 0}> crc16_arc{};
+
+  // CRC-8/SMBUS
+  inline constexpr std::constexpr_wrapper<crc_params{8, 0x07, 0, false, 0}> crc8{};
+
+  namespace __detail
+  {
+    template <crc_params _Pp>
+      concept __valid_crc = _Pp.width >= 1 and _Pp.width <= 64
+			      and (_Pp.width == 64 or (_Pp.poly >> _Pp.width) == 0);
+
+    template <int _Width>
+      using __crc_uint
+	= std::conditional_t<(_Width <= 8), std::uint8_t,
+			     std::conditional_t<(_Width <= 16), std::uint16_t,
+						std::conditional_t<(_Width <= 32), std::uint32_t,
+								   std::uint64_t>>>;
+
+    constexpr std::uint64_t
+    __crc_mask(int __width)
+    { return __width == 64 ? ~0ull : (1ull << __width) - 1; }
+
+    constexpr std::uint64_t
+    __crc_reflect(std::uint64_t __x, int __width)
+    {
+      std::uint64_t __r = 0;
+      for (int __i = 0; __i < __width; ++__i, __x >>= 1)
+	__r = (__r << 1) | (__x & 1);
+      return __r;
+    }
+
+    // The register: for reflected CRCs the CRC itself (LSB first); otherwise the CRC aligned to
+    // the top of a 64-bit register, so that bytes are always shifted out at bit 56.
+    template <crc_params _Pp>
+      using __crc_reg_t
+	= std::conditional_t<_Pp.reflect, __crc_uint<_Pp.width>, std::uint64_t>;
+
+    template <crc_params _Pp>
+      constexpr __crc_reg_t<_Pp>
+      __crc_initial_register()
+      {
+	if constexpr (_Pp.reflect)
+	  return __crc_reflect(_Pp.init, _Pp.width);
+	else
+	  return _Pp.init << (64 - _Pp.width);
+      }
+
+    // Slicing-by-8 tables: [k][b] is the register contribution of byte b followed by k zero
+    // bytes. 8 * 256 entries of the register type.
+    template <crc_params _Pp>
+      constexpr auto
+      __make_crc_tables()
+      {
+	using _Rp = __crc_reg_t<_Pp>;
+	std::array<std::array<_Rp, 256>, 8> __t = {};
+	for (unsigned __b = 0; __b < 256; ++__b)
+	  {
+	    if constexpr (_Pp.reflect)
+	      {
+		const std::uint64_t __poly = __crc_reflect(_Pp.poly, _Pp.width);
+		std::uint64_t __r = __b;
+		for (int __i = 0; __i < 8; ++__i)
+		  __r = (__r >> 1) ^ ((__r & 1) ? __poly : 0);
+		__t[0][__b] = _Rp(__r);
+	      }
+	    else
+	      {
+		const std::uint64_t __poly = _Pp.poly << (64 - _Pp.width);
+		std::uint64_t __r = std::uint64_t(__b) << 56;
+		for (int __i = 0; __i < 8; ++__i)
+		  __r = (__r << 1) ^ ((__r >> 63) ? __poly : 0);
+		__t[0][__b] = __r;
+	      }
+	  }
+	for (int __k = 1; __k < 8; ++__k)
+	  for (unsigned __b = 0; __b < 256; ++__b)
+	    {
+	      const _Rp __prev = __t[__k - 1][__b];
+	      if constexpr (_Pp.reflect)
+		__t[__k][__b] = _Rp((std::uint64_t(__prev) >> 8) ^ __t[0][__prev & 0xff]);
+	      else
+		__t[__k][__b] = (__prev << 8) ^ __t[0][__prev >> 56];
+	    }
+	return __t;
+      }
+
+    template <crc_params _Pp>
+      inline constexpr auto __crc_tables = __make_crc_tables<_Pp>();
+
+    template <crc_params _Pp, typename _Byte>
+      constexpr __crc_reg_t<_Pp>
+      __crc_bytewise(__crc_reg_t<_Pp> __r, const _Byte* __p, std::size_t __n)
+      {
+	constexpr auto& __t0 = __crc_tables<_Pp>[0];
+	for (std::size_t __i = 0; __i < __n; ++__i)
+	  {
+	    const unsigned char __b = static_cast<unsigned char>(__p[__i]);
+	    if constexpr (_Pp.reflect)
+	      __r = __crc_reg_t<_Pp>((std::uint64_t(__r) >> 8) ^ __t0[(__r ^ __b) & 0xff]);
+	    else
+	      __r = (__r << 8) ^ __t0[(__r >> 56) ^ __b];
+	  }
+	return __r;
+      }
+
+    template <typename _Byte>
+      inline std::uint64_t
+      __crc_load64(const _Byte* __p)
+      {
+	std::uint64_t __x;
+	__builtin_memcpy(&__x, __p, 8);
+	if constexpr (std::endian::native == std::endian::big)
+	  return __x;
+	else
+	  return __builtin_bswap64(__x);
+      }
+
+    template <typename _Byte>
+      inline std::uint64_t
+      __crc_load64_le(const _Byte* __p)
+      {
+	std::uint64_t __x;
+	__builtin_memcpy(&__x, __p, 8);
+	if constexpr (std::endian::native == std::endian::little)
+	  return __x;
+	else
+	  return __builtin_bswap64(__x);
+      }
+
+    // 8 bytes per step, 8 independent table lookups.
+    template <crc_params _Pp, typename _Byte>
+      inline __crc_reg_t<_Pp>
+      __crc_slice8(__crc_reg_t<_Pp> __r, const _Byte* __p, std::size_t __n)
+      {
+	constexpr auto& __t = __crc_tables<_Pp>;
+	for (; __n >= 8; __n -= 8, __p += 8)
+	  {
+	    if constexpr (_Pp.reflect)
+	      {
+		const std::uint64_t __x = __r ^ __crc_load64_le(__p);
+		__r = __crc_reg_t<_Pp>(__t[7][__x & 0xff] ^ __t[6][(__x >> 8) & 0xff]
+					 ^ __t[5][(__x >> 16) & 0xff] ^ __t[4][(__x >> 24) & 0xff]
+					 ^ __t[3][(__x >> 32) & 0xff] ^ __t[2][(__x >> 40) & 0xff]
+					 ^ __t[1][(__x >> 48) & 0xff] ^ __t[0][__x >> 56]);
+	      }
+	    else
+	      {
+		const std::uint64_t __x = __r ^ __crc_load64(__p);
+		__r = __t[7][__x >> 56] ^ __t[6][(__x >> 48) & 0xff] ^ __t[5][(__x >> 40) & 0xff]
+			^ __t[4][(__x >> 32) & 0xff] ^ __t[3][(__x >> 24) & 0xff]
+			^ __t[2][(__x >> 16) & 0xff] ^ __t[1][(__x >> 8) & 0xff]
+			^ __t[0][__x & 0xff];
+	      }
+	  }
+	return __crc_bytewise<_Pp>(__r, __p, __n);
+      }
+
+    inline constexpr crc_params __crc32c_params = crc32c.value;
+
+#ifdef __SSE4_2__
+    // The crc32 instruction implements exactly the CRC-32C register update.
+    template <typename _Byte>
+      inline std::uint32_t
+      __crc32c_hw(std::uint32_t __r, const _Byte* __p, std::size_t __n)
+      {
+	std::uint64_t __r64 = __r;
+	for (; __n >= 8; __n -= 8, __p += 8)
+	  __r64 = _mm_crc32_u64(__r64, __crc_load64_le(__p));
+	__r = std::uint32_t(__r64);
+	for (; __n > 0; --__n, ++__p)
+	  __r = _mm_crc32_u8(__r, static_cast<unsigned char>(*__p));
+	return __r;
+      }
+#endif
+
+    // x^__n mod P, for the folding constants below.
+    constexpr std::uint64_t
+    __crc_xnmod(int __n, std::uint64_t __poly, int __width)
+    {
+      std::uint64_t __r = 1;
+      for (int __i = 0; __i < __n; ++__i)
+	{
+	  const bool __carry = (__r >> (__width - 1)) & 1;
+	  __r = (__r << 1) & __crc_mask(__width);
+	  if (__carry)
+	    __r ^= __poly;
+	}
+      return __r;
+    }
+
+    // The constant that folds a 64-bit half of a 128-bit block __distance bits ahead, in the
+    // bit-reflected domain of pclmulqdq (hence the shift by one).
+    constexpr std::uint64_t
+    __crc_fold_constant(std::uint64_t __poly, int __distance)
+    { return __crc_reflect(__crc_xnmod(__distance, __poly, 32), 32) << 1; }
+
+    // Whether the CRC can be computed by carry-less multiplication folding: 32-bit reflected
+    // CRCs (any polynomial; the constants are computed from it).
+    template <crc_params _Pp>
+      inline constexpr bool __crc_foldable = _Pp.width == 32 and _Pp.reflect;
+
+#if defined __PCLMUL__ and defined __SSE4_1__
+    // Folds 64-byte blocks into four 128-bit accumulators, then into one, with pclmulqdq (as in
+    // Intel's "Fast CRC Computation Using PCLMULQDQ"). The remaining 128 bits are congruent to the
+    // consumed prefix, so the CRC of those 16 bytes plus the tail is the CRC of the input. Requires
+    // __n >= 64. Returns the number of consumed bytes.
+    template <crc_params _Pp, typename _Byte>
+      inline std::size_t
+      __crc_fold(std::uint32_t& __r, const _Byte* __p, std::size_t __n)
+      {
+	constexpr std::uint64_t __k1 = __crc_fold_constant(_Pp.poly, 4 * 128 + 32);
+	constexpr std::uint64_t __k2 = __crc_fold_constant(_Pp.poly, 4 * 128 - 32);
+	constexpr std::uint64_t __k3 = __crc_fold_constant(_Pp.poly, 128 + 32);
+	constexpr std::uint64_t __k4 = __crc_fold_constant(_Pp.poly, 128 - 32);
+	const __m128i __k12 = _mm_set_epi64x(__k2, __k1);
+	const __m128i __k34 = _mm_set_epi64x(__k4, __k3);
+	auto __load = [](const _Byte* __q) {
+	  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(__q));
+	};
+	auto __fold = [](__m128i __x, __m128i __k, __m128i __next)
+	  __attribute__((__always_inline__)) {
+	  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(__x, __k, 0x00),
+					     _mm_clmulepi64_si128(__x, __k, 0x11)), __next);
+	};
+	// the register is added to the first 32 bits of the message
+	__m128i __x0 = _mm_xor_si128(__load(__p), _mm_cvtsi32_si128(int(__r)));
+	__m128i __x1 = __load(__p + 16);
+	__m128i __x2 = __load(__p + 32);
+	__m128i __x3 = __load(__p + 48);
+	const _Byte* const __begin = __p;
+	__p += 64;
+	__n -= 64;
+	for (; __n >= 64; __n -= 64, __p += 64)
+	  {
+	    __x0 = __fold(__x0, __k12, __load(__p));
+	    __x1 = __fold(__x1, __k12, __load(__p + 16));
+	    __x2 = __fold(__x2, __k12, __load(__p + 32));
+	    __x3 = __fold(__x3, __k12, __load(__p + 48));
+	  }
+	__m128i __x = __fold(__fold(__fold(__x0, __k34, __x1), __k34, __x2), __k34, __x3);
+	for (; __n >= 16; __n -= 16, __p += 16)
+	  __x = __fold(__x, __k34, __load(__p));
+	alignas(16) unsigned char __buf[16];
+	_mm_store_si128(reinterpret_cast<__m128i*>(__buf), __x);
+	__r = __crc_slice8<_Pp>(0, __buf, 16);
+	return std::size_t(__p - __begin);
+      }
+#endif
+
+    template <crc_params _Pp, typename _Byte>
+      constexpr __crc_reg_t<_Pp>
+      __crc_update(__crc_reg_t<_Pp> __r, const _Byte* __p, std::size_t __n)
+      {
+	if (std::is_constant_evaluated())
+	  return __crc_bytewise<_Pp>(__r, __p, __n);
+#if defined __PCLMUL__ and defined __SSE4_1__
+	if constexpr (__crc_foldable<_Pp>)
+	  if (__n >= 64)
+	    {
+	      const std::size_t __done = __crc_fold<_Pp>(__r, __p, __n);
+	      __p += __done;
+	      __n -= __done;
+	    }
+#endif
+#ifdef __SSE4_2__
+	if constexpr (_Pp == __crc32c_params)
+	  return __crc32c_hw(__r, __p, __n);
+#endif
+	return __crc_slice8<_Pp>(__r, __p, __n);
+      }
+
+    template <crc_params _Pp>
+      constexpr __crc_uint<_Pp.width>
+      __crc_finalize(__crc_reg_t<_Pp> __r)
+      {
+	if constexpr (_Pp.reflect)
+	  return __crc_uint<_Pp.width>(__r ^ _Pp.xorout);
+	else
+	  return __crc_uint<_Pp.width>((__r >> (64 - _Pp.width)) ^ _Pp.xorout);
+      }
+
+    template <typename _Rg>
+      concept __byte_range = std::ranges::contiguous_range<_Rg>
+			       and std::ranges::sized_range<_Rg>
+			       and sizeof(std::ranges::range_value_t<_Rg>) == 1
+			       and std::is_trivially_copyable_v<std::ranges::range_value_t<_Rg>>;
+  }
+
+  // Incremental CRC computation:
+  //   vir::crc_engine crc(vir::crc32c);
+  //   crc.update(header, sizeof(header));
+  //   crc.update(payload);
+  //   if (crc.value() != trailer) ...
+  // The implementation is selected from the parameters at compile time:
+  // - slicing-by-8 tables, generated at compile time (any CRC up to 64 bits);
+  // - for 32-bit reflected CRCs (CRC-32, CRC-32C, ...) and -mpclmul -msse4.1: pclmulqdq folding
+  //   of 64-byte blocks, with constants computed from the polynomial at compile time;
+  // - for CRC-32C and -msse4.2: the crc32 instruction.
+  // In constant expressions, the tables are used byte by byte.
+  template <std::constexpr_value<crc_params> _Pp>
+    requires __detail::__valid_crc<_Pp::value>
+    class crc_engine
+    {
+      static constexpr crc_params _S_params = _Pp::value;
+
+      __detail::__crc_reg_t<_S_params> _M_reg = __detail::__crc_initial_register<_S_params>();
+
+    public:
+      using result_type = __detail::__crc_uint<_S_params.width>;
+
+      static constexpr _Pp params{};
+
+      constexpr
+      crc_engine() = default;
+
+      constexpr explicit
+      crc_engine(_Pp)
+      {}
+
+      template <typename _Byte>
+	requires (sizeof(_Byte) == 1 and std::is_trivially_copyable_v<_Byte>)
+	constexpr crc_engine&
+	update(const _Byte* __p, std::size_t __n)
+	{
+	  _M_reg = __detail::__crc_update<_S_params>(_M_reg, __p, __n);
+	  return *this;
+	}
+
+      template <__detail::__byte_range _Rg>
+	constexpr crc_engine&
+	update(const _Rg& __r)
+	{ return update(std::ranges::data(__r), std::ranges::size(__r)); }
+
+      constexpr result_type
+      value() const
+      { return __detail::__crc_finalize<_S_params>(_M_reg); }
+
+      constexpr void
+      reset()
+      { _M_reg = __detail::__crc_initial_register<_S_params>(); }
+    };
+
+  // The CRC of __n bytes at __p:
+  //   std::uint32_t c = vir::crc(vir::crc32, buf, len);
+  template <std::constexpr_value<crc_params> _Pp, typename _Byte>
+    requires __detail::__valid_crc<_Pp::value>
+	       and (sizeof(_Byte) == 1 and std::is_trivially_copyable_v<_Byte>)
+    constexpr auto
+    crc(_Pp __params, const _Byte* __p, std::size_t __n)
+    { return crc_engine(__params).update(__p, __n).value(); }
+
+  // The CRC of a contiguous range of bytes (e.g. a std::string_view or std::span<std::byte>).
+  template <std::constexpr_value<crc_params> _Pp, __detail::__byte_range _Rg>
+    requires __detail::__valid_crc<_Pp::value>
+    constexpr auto
+    crc(_Pp __params, const _Rg& __r)
+    { return crc_engine(__params).update(__r).value(); }
+}
+
+#endif  // VIR_CW_CRC_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
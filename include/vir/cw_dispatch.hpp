@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_DISPATCH_HPP_
+#define VIR_CW_DISPATCH_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    template <typename _Rp, typename _Fp, std::size_t _Ip>
+      constexpr _Rp
+      __dispatch_thunk(_Fp& __f)
+      { return static_cast<_Rp>(std::invoke(__f, std::cw<_Ip>)); }
+
+    template <typename _Fp, typename _Seq>
+      struct __dispatch_table;
+
+    // One function per index, in a constant array (i.e. in .rodata). Calling through it is a
+    // single indirect call, independent of the number of entries and of how the compiler would
+    // lower an equivalent switch (for large or sparse switches, GCC and Clang sometimes emit a
+    // binary search).
+    template <typename _Fp, std::size_t... _Is>
+      struct __dispatch_table<_Fp, std::index_sequence<_Is...>>
+      {
+	using _Rp = std::common_type_t<std::invoke_result_t<_Fp&, std::constexpr_wrapper<_Is>>...>;
+
+	static constexpr _Rp (*_S_table[])(_Fp&) = {&__dispatch_thunk<_Rp, _Fp, _Is>...};
+      };
+  }
+
+  // Calls __f(std::cw<__i>) for a runtime index __i in [0, _Np::value), i.e. turns a runtime index
+  // into a constant via a jump table. The result is the common type of all __f(cw<I>). If __i is a
+  // constexpr_value, __f is called directly (and may return any type).
+  //   vir::dispatch(k, std::cw<3uz>, [&](auto i) { return std::get<i>(tuple).size(); })
+  template <typename _Ip, std::constexpr_value<std::size_t> _Np, typename _Fp>
+    requires std::convertible_to<_Ip, std::size_t>
+    constexpr decltype(auto)
+    dispatch(_Ip __i, _Np, _Fp&& __f)
+    {
+      if constexpr (std::constexpr_value<_Ip>)
+	{
+	  static_assert(_Ip::value < _Np::value, "index out of range");
+	  return std::invoke(__f, std::cw<std::size_t(_Ip::value)>);
+	}
+      else
+	{
+	  using _Table = __detail::__dispatch_table<std::remove_reference_t<_Fp>,
+						    std::make_index_sequence<_Np::value>>;
+	  return _Table::_S_table[std::size_t(__i)](__f);
+	}
+    }
+}
+
+#endif  // VIR_CW_DISPATCH_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_ENUM_HPP_
+#define VIR_CW_ENUM_HPP_
+
+#include <constexpr_wrapper.hpp>
+#include <vir/cw_dispatch.hpp>
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace vir
+{
+  // Declares the range of values of an enum type that the functions below cover:
+  //   template <>
+  //     struct vir::enum_bounds<msg_type>
+  //     {
+  //       static constexpr msg_type min = msg_type::hello;
+  //       static constexpr msg_type max = msg_type::goodbye;
+  //     };
+  // Every value in [min, max] gets a table entry, whether it is an enumerator or not.
+  template <typename _Ep>
+    struct enum_bounds;
+
+  template <typename _Ep>
+    concept bounded_enum = std::is_enum_v<_Ep> and requires {
+      { enum_bounds<_Ep>::min } -> std::convertible_to<_Ep>;
+      { enum_bounds<_Ep>::max } -> std::convertible_to<_Ep>;
+    } and std::to_underlying(enum_bounds<_Ep>::min) <= std::to_underlying(enum_bounds<_Ep>::max);
+
+  // The number of values in [min, max], as a constant.
+  template <bounded_enum _Ep>
+    inline constexpr std::constexpr_wrapper<
+		       std::size_t(std::to_underlying(enum_bounds<_Ep>::max)
+				     - std::to_underlying(enum_bounds<_Ep>::min)) + 1>
+      enum_size{};
+
+  // The position of __e in [min, max]. For a constexpr_value, the position as a constant.
+  template <bounded_enum _Ep>
+    constexpr std::size_t
+    enum_index(_Ep __e)
+    {
+      using _Up = std::make_unsigned_t<std::underlying_type_t<_Ep>>;
+      return _Up(_Up(std::to_underlying(__e)) - _Up(std::to_underlying(enum_bounds<_Ep>::min)));
+    }
+
+  template <std::constexpr_value _Ep>
+    requires bounded_enum<typename _Ep::value_type>
+    constexpr auto
+    enum_index(_Ep)
+    { return std::cw<vir::enum_index(_Ep::value)>; }
+
+  namespace __detail
+  {
+    template <bounded_enum _Ep, std::size_t _Ip>
+      inline constexpr _Ep __enum_at
+	= _Ep(std::underlying_type_t<_Ep>(std::to_underlying(enum_bounds<_Ep>::min) + _Ip));
+
+    // The name of the enumerator _Vp, from the signature of this function (the only place where
+    // GCC and Clang reveal it). For a value without enumerator, the compiler prints a cast
+    // instead, e.g. `(msg_type)7`, and the name is empty.
+    template <auto _Vp>
+      consteval std::string_view
+      __enum_name_of()
+      {
+	const std::string_view __sig = __PRETTY_FUNCTION__;
+	std::size_t __b = __sig.find("_Vp = ");
+	if (__b == __sig.npos)
+	  return {};
+	__b += 6;
+	const std::size_t __e = __sig.find_first_of(";]", __b);
+	std::string_view __name = __sig.substr(__b, __e - __b);
+	if (__name.empty() or __name[0] == '(')
+	  return {};
+	if (const std::size_t __colon = __name.rfind(':'); __colon != __name.npos)
+	  __name.remove_prefix(__colon + 1);
+	return __name;
+      }
+
+    // All names, '\0'-terminated, in one array, plus the offset of each name. Both are emitted as
+    // constant data, so enum_name is two loads.
+    template <std::size_t _Np, std::size_t _Chars>
+      struct __enum_name_table
+      {
+	char _M_chars[_Chars] = {};
+	unsigned _M_offset[_Np + 1] = {};
+      };
+
+    template <typename _Ep, std::size_t... _Is>
+      consteval auto
+      __make_enum_name_table(std::index_sequence<_Is...>)
+      {
+	constexpr std::string_view __names[] = {__enum_name_of<__enum_at<_Ep, _Is>>()...};
+	constexpr std::size_t __chars = (0 + ... + (__names[_Is].size() + 1));
+	__enum_name_table<sizeof...(_Is), __chars> __t = {};
+	unsigned __off = 0;
+	for (std::size_t __i = 0; __i < sizeof...(_Is); ++__i)
+	  {
+	    __t._M_offset[__i] = __off;
+	    for (char __c : __names[__i])
+	      __t._M_chars[__off++] = __c;
+	    __t._M_chars[__off++] = '\0';
+	  }
+	__t._M_offset[sizeof...(_Is)] = __off;
+	return __t;
+      }
+
+    template <typename _Ep>
+      inline constexpr auto __enum_names
+	= __make_enum_name_table<_Ep>(std::make_index_sequence<enum_size<_Ep>>());
+  }
+
+  // The name of the enumerator __e (without scope), or an empty string if __e is not an
+  // enumerator or out of bounds. The names are a table in .rodata, for logging:
+  //   std::printf("got %s\n", vir::enum_name(m.type).data());  // '\0'-terminated
+  template <bounded_enum _Ep>
+    constexpr std::string_view
+    enum_name(_Ep __e)
+    {
+      constexpr auto& __t = __detail::__enum_names<_Ep>;
+      const std::size_t __i = vir::enum_index(__e);
+      if (__i >= enum_size<_Ep>)
+	return {};
+      return {__t._M_chars + __t._M_offset[__i],
+	      __t._M_offset[__i + 1] - __t._M_offset[__i] - 1};
+    }
+
+  template <std::constexpr_value _Ep>
+    requires bounded_enum<typename _Ep::value_type>
+    constexpr std::string_view
+    enum_name(_Ep)
+    { return vir::enum_name(_Ep::value); }
+
+  // Calls __f(std::cw<__e>), through a dense jump table over [min, max] (see vir::dispatch), so
+  // that every handler is instantiated for a constant enumerator:
+  //   vir::enum_dispatch(m.type, [&](auto type) { return handle(type, m); });
+  // where handle is overloaded or specialized on the constant. __e must be in [min, max]. If __e is
+  // a constexpr_value, __f is called directly.
+  template <typename _Ep, typename _Fp>
+    requires bounded_enum<_Ep> or (std::constexpr_value<_Ep>
+				     and bounded_enum<typename _Ep::value_type>)
+    constexpr decltype(auto)
+    enum_dispatch(_Ep __e, _Fp&& __f)
+    {
+      if constexpr (std::constexpr_value<_Ep>)
+	return std::invoke(__f, __e);
+      else
+	return vir::dispatch(vir::enum_index(__e), enum_size<_Ep>,
+			     [&__f](auto __i) -> decltype(auto) {
+			       constexpr _Ep __v = __detail::__enum_at<_Ep, decltype(__i)::value>;
+			       return std::invoke(__f, std::cw<__v>);
+			     });
+    }
+}
+
+#endif  // VIR_CW_ENUM_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,266 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_FIXED_HPP_
+#define VIR_CW_FIXED_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace vir
+{
+  template <std::integral _Tp, int _Frac>
+    requires (not std::same_as<_Tp, bool> and _Frac >= 0
+		and _Frac <= int(sizeof(_Tp) * 8) - std::is_signed_v<_Tp>)
+    struct fixed;
+
+  namespace __detail
+  {
+    template <typename _Tp>
+      struct __is_fixed
+      : std::false_type
+      {};
+
+    template <typename _Tp, int _Frac>
+      struct __is_fixed<fixed<_Tp, _Frac>>
+      : std::true_type
+      {};
+
+    // The raw type of a product: twice the width of the wider operand (up to 64 bits, or 128 if
+    // available), so that the full product is exact. Signed if either operand is signed.
+    template <std::size_t _Bytes, bool _Signed>
+      constexpr auto
+      __fixed_int()
+      {
+	if constexpr (_Bytes <= 1)
+	  return std::conditional_t<_Signed, std::int8_t, std::uint8_t>();
+	else if constexpr (_Bytes <= 2)
+	  return std::conditional_t<_Signed, std::int16_t, std::uint16_t>();
+	else if constexpr (_Bytes <= 4)
+	  return std::conditional_t<_Signed, std::int32_t, std::uint32_t>();
+#ifdef __SIZEOF_INT128__
+	else if constexpr (_Bytes > 8)
+	  return std::conditional_t<_Signed, __int128, unsigned __int128>();
+#endif
+	else
+	  return std::conditional_t<_Signed, std::int64_t, std::uint64_t>();
+      }
+
+    template <typename _Tp, typename _Up>
+      using __fixed_product_t
+	= decltype(__fixed_int<2 * (sizeof(_Tp) > sizeof(_Up) ? sizeof(_Tp) : sizeof(_Up)),
+			       std::is_signed_v<_Tp> or std::is_signed_v<_Up>>());
+
+    template <typename _Fp, int _Np>
+      inline constexpr _Fp __fixed_exp2 = [] {
+	_Fp __r = 1;
+	for (int __i = 0; __i < _Np; ++__i)
+	  __r *= 2;
+	return __r;
+      }();
+
+    // The wider of the two raw types (common_type would promote to int). Signed if either is.
+    template <typename _Tp, typename _Up>
+      using __fixed_common_t
+	= decltype(__fixed_int<(sizeof(_Tp) > sizeof(_Up) ? sizeof(_Tp) : sizeof(_Up)),
+			       std::is_signed_v<_Tp> or std::is_signed_v<_Up>>());
+
+    // __x * 2^_Shift for a constant shift of either sign (negative: floor division).
+    template <int _Shift, typename _Rp, typename _Tp>
+      constexpr _Rp
+      __fixed_shift(_Tp __x)
+      {
+	if constexpr (_Shift >= 0)
+	  return _Rp(_Rp(__x) << _Shift);
+	else
+	  return _Rp(_Rp(__x) >> -_Shift);
+      }
+  }
+
+  // Binary fixed-point number: the value is _M_raw * 2^-_Frac. Structural, so that
+  // `std::cw<vir::fixed<std::int16_t, 15>::from(0.5)>` is valid and the constexpr_wrapper operators
+  // compute fixed-point constants at compile time.
+  //
+  // All operations are integer operations on _M_raw with constant shift counts, which compile to
+  // shift immediates (and vectorize; a Q15 vector has twice the lanes of a float vector). The
+  // fractional bits of the result of a mixed-scale operation are computed at compile time:
+  //   fixed<T, F1> * fixed<U, F2> -> fixed<2x wide, F1 + F2>   (exact)
+  //   fixed<T, F1> / fixed<U, F2> -> fixed<T, F1>
+  //   fixed<T, F1> +- fixed<U, F2> -> fixed<wider of T, U, max(F1, F2)>
+  // Use vir::rescale to go back to the working format, e.g. for Q15:
+  //   q15 y = vir::rescale<std::int16_t>(a * b, std::cw<15>);
+  template <std::integral _Tp, int _Frac>
+    requires (not std::same_as<_Tp, bool> and _Frac >= 0
+		and _Frac <= int(sizeof(_Tp) * 8) - std::is_signed_v<_Tp>)
+    struct fixed
+    {
+      _Tp _M_raw;
+
+      using value_type = _Tp;
+
+      static constexpr std::constexpr_wrapper<_Frac> frac_bits{};
+
+      static constexpr fixed
+      from_raw(_Tp __raw)
+      { return {__raw}; }
+
+      // Rounded to nearest (ties away from zero).
+      template <std::floating_point _Fp>
+	static constexpr fixed
+	from(_Fp __x)
+	{
+	  const _Fp __scaled = __x * __detail::__fixed_exp2<_Fp, _Frac>;
+	  return {_Tp(__scaled < 0 ? __scaled - _Fp(.5) : __scaled + _Fp(.5))};
+	}
+
+      template <std::integral _Ip>
+	static constexpr fixed
+	from(_Ip __x)
+	{ return {_Tp(_Tp(__x) << _Frac)}; }
+
+      constexpr _Tp
+      raw() const
+      { return _M_raw; }
+
+      // A multiplication by the constant 2^-_Frac.
+      template <std::floating_point _Fp>
+	explicit constexpr
+	operator _Fp() const
+	{
+	  constexpr _Fp __scale = _Fp(1) / __detail::__fixed_exp2<_Fp, _Frac>;
+	  return _Fp(_M_raw) * __scale;
+	}
+
+      constexpr fixed
+      operator+() const
+      { return *this; }
+
+      constexpr fixed
+      operator-() const
+      { return {_Tp(-_M_raw)}; }
+
+      friend constexpr bool
+      operator==(const fixed&, const fixed&) = default;
+
+      friend constexpr auto
+      operator<=>(const fixed& __a, const fixed& __b)
+      { return __a._M_raw <=> __b._M_raw; }
+
+      friend constexpr fixed
+      operator+(const fixed& __a, const fixed& __b)
+      { return {_Tp(__a._M_raw + __b._M_raw)}; }
+
+      friend constexpr fixed
+      operator-(const fixed& __a, const fixed& __b)
+      { return {_Tp(__a._M_raw - __b._M_raw)}; }
+
+      // Scaling by an integer does not change the format.
+      template <std::integral _Ip>
+	friend constexpr fixed
+	operator*(const fixed& __a, _Ip __b)
+	{ return {_Tp(__a._M_raw * __b)}; }
+
+      template <std::integral _Ip>
+	friend constexpr fixed
+	operator*(_Ip __a, const fixed& __b)
+	{ return {_Tp(__a * __b._M_raw)}; }
+    };
+
+  template <typename _Tp>
+    concept fixed_point = __detail::__is_fixed<std::remove_cvref_t<_Tp>>::value;
+
+  // A fixed-point value with the fractional bits given as a constexpr_value:
+  //   auto gain = vir::make_fixed<std::int16_t>(0.75, std::cw<15>);
+  template <std::integral _Tp, typename _Vp, std::constexpr_value<int> _Fp>
+    requires std::is_arithmetic_v<_Vp>
+    constexpr fixed<_Tp, _Fp::value>
+    make_fixed(_Vp __x, _Fp)
+    { return fixed<_Tp, _Fp::value>::from(__x); }
+
+  // __x converted to _Fq::value fractional bits (and raw type _Up, if given): a left shift or an
+  // arithmetic right shift (rounding toward negative infinity) by a constant. The shift is done in
+  // the wider of the two raw types, so that e.g. a 32-bit product rescaled to Q15 is exact before
+  // it is narrowed.
+  template <typename _Up = void, typename _Tp, int _Frac, std::constexpr_value<int> _Fq>
+    constexpr auto
+    rescale(const fixed<_Tp, _Frac>& __x, _Fq)
+    {
+      using _Rp = std::conditional_t<std::is_void_v<_Up>, _Tp, _Up>;
+      using _Wp = std::conditional_t<(sizeof(_Rp) > sizeof(_Tp)), _Rp, _Tp>;
+      return fixed<_Rp, _Fq::value>{
+	_Rp(__detail::__fixed_shift<_Fq::value - _Frac, _Wp>(__x._M_raw))};
+    }
+
+  // Mixed-scale operators. The result formats are computed via the constexpr_wrapper operators on
+  // frac_bits.
+  template <typename _Tp, int _Fa, typename _Up, int _Fb>
+    constexpr auto
+    operator*(const fixed<_Tp, _Fa>& __a, const fixed<_Up, _Fb>& __b)
+    {
+      using _Pp = __detail::__fixed_product_t<_Tp, _Up>;
+      constexpr auto __frac = fixed<_Tp, _Fa>::frac_bits + fixed<_Up, _Fb>::frac_bits;
+      return fixed<_Pp, __frac>{_Pp(_Pp(__a._M_raw) * _Pp(__b._M_raw))};
+    }
+
+  // The dividend is shifted left by the fractional bits of the divisor (in the product type) first,
+  // so that the quotient keeps the format of the dividend.
+  template <typename _Tp, int _Fa, typename _Up, int _Fb>
+    constexpr fixed<_Tp, _Fa>
+    operator/(const fixed<_Tp, _Fa>& __a, const fixed<_Up, _Fb>& __b)
+    {
+      using _Pp = __detail::__fixed_product_t<_Tp, _Up>;
+      return {_Tp(__detail::__fixed_shift<_Fb, _Pp>(__a._M_raw) / _Pp(__b._M_raw))};
+    }
+
+  template <typename _Tp, int _Fa, typename _Up, int _Fb>
+    requires (_Fa != _Fb or not std::same_as<_Tp, _Up>)
+    constexpr auto
+    operator+(const fixed<_Tp, _Fa>& __a, const fixed<_Up, _Fb>& __b)
+    {
+      using _Rp = __detail::__fixed_common_t<_Tp, _Up>;
+      constexpr auto __frac = std::cw<(_Fa > _Fb ? _Fa : _Fb)>;
+      return fixed<_Rp, __frac>{_Rp(vir::rescale<_Rp>(__a, __frac)._M_raw
+				     + vir::rescale<_Rp>(__b, __frac)._M_raw)};
+    }
+
+  template <typename _Tp, int _Fa, typename _Up, int _Fb>
+    requires (_Fa != _Fb or not std::same_as<_Tp, _Up>)
+    constexpr auto
+    operator-(const fixed<_Tp, _Fa>& __a, const fixed<_Up, _Fb>& __b)
+    {
+      using _Rp = __detail::__fixed_common_t<_Tp, _Up>;
+      constexpr auto __frac = std::cw<(_Fa > _Fb ? _Fa : _Fb)>;
+      return fixed<_Rp, __frac>{_Rp(vir::rescale<_Rp>(__a, __frac)._M_raw
+				     - vir::rescale<_Rp>(__b, __frac)._M_raw)};
+    }
+
+  // Compared in the common format (max(F1, F2) fractional bits, the wider raw type).
+  template <typename _Tp, int _Fa, typename _Up, int _Fb>
+    requires (_Fa != _Fb or not std::same_as<_Tp, _Up>)
+    constexpr bool
+    operator==(const fixed<_Tp, _Fa>& __a, const fixed<_Up, _Fb>& __b)
+    {
+      using _Rp = __detail::__fixed_common_t<_Tp, _Up>;
+      constexpr auto __frac = std::cw<(_Fa > _Fb ? _Fa : _Fb)>;
+      return vir::rescale<_Rp>(__a, __frac) == vir::rescale<_Rp>(__b, __frac);
+    }
+
+  template <typename _Tp, int _Fa, typename _Up, int _Fb>
+    requires (_Fa != _Fb or not std::same_as<_Tp, _Up>)
+    constexpr auto
+    operator<=>(const fixed<_Tp, _Fa>& __a, const fixed<_Up, _Fb>& __b)
+    {
+      using _Rp = __detail::__fixed_common_t<_Tp, _Up>;
+      constexpr auto __frac = std::cw<(_Fa > _Fb ? _Fa : _Fb)>;
+      return vir::rescale<_Rp>(__a, __frac) <=> vir::rescale<_Rp>(__b, __frac);
+    }
+}
+
+#endif  // VIR_CW_FIXED_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,278 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_LINALG_HPP_
+#define VIR_CW_LINALG_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <cstddef>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    // Calls __f(cw<0>), __f(cw<1>), ..., __f(cw<_Np - 1>).
+    template <std::size_t _Np, typename _Fp>
+      [[gnu::always_inline]] constexpr void
+      __static_for(_Fp&& __f)
+      {
+	[&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	  (__f(std::cw<_Is>), ...);
+	}(std::make_index_sequence<_Np>());
+      }
+
+    // Kernels with at most this many multiply-adds are fully unrolled. Straight-line code keeps
+    // small operands in registers and lets the compiler schedule all products freely, but its
+    // size (and compile time) grows with the number of multiply-adds, so larger shapes use the
+    // blocked loops instead. 8x8x8 is the largest cube that is still unrolled.
+    inline constexpr std::size_t __linalg_unroll_max = 512;
+
+    // Tile size (in elements) of the blocked kernels used for larger shapes.
+    inline constexpr std::size_t __linalg_block = 32;
+  }
+
+  // Fixed-size vector. Aggregate and structural, i.e. `std::cw<vec<int, 3>{1, 2, 3}>` is valid and
+  // the constexpr_wrapper operators evaluate vector arithmetic at compile time.
+  template <typename _Tp, std::size_t _Np>
+    requires (_Np > 0)
+    struct vec
+    {
+      _Tp _M_elems[_Np];
+
+      using value_type = _Tp;
+
+      static constexpr std::constexpr_wrapper<_Np> size{};
+
+      constexpr _Tp&
+      operator[](std::size_t __i)
+      { return _M_elems[__i]; }
+
+      constexpr const _Tp&
+      operator[](std::size_t __i) const
+      { return _M_elems[__i]; }
+
+      friend constexpr bool
+      operator==(const vec&, const vec&) = default;
+
+      friend constexpr vec
+      operator+(const vec& __a, const vec& __b)
+      {
+	vec __r;
+	__detail::__static_for<_Np>([&](auto __i) { __r[__i] = __a[__i] + __b[__i]; });
+	return __r;
+      }
+
+      friend constexpr vec
+      operator-(const vec& __a, const vec& __b)
+      {
+	vec __r;
+	__detail::__static_for<_Np>([&](auto __i) { __r[__i] = __a[__i] - __b[__i]; });
+	return __r;
+      }
+
+      friend constexpr vec
+      operator*(_Tp __s, const vec& __a)
+      {
+	vec __r;
+	__detail::__static_for<_Np>([&](auto __i) { __r[__i] = __s * __a[__i]; });
+	return __r;
+      }
+    };
+
+  // Fixed-size row-major matrix. Aggregate and structural, like vec.
+  template <typename _Tp, std::size_t _Rows, std::size_t _Cols>
+    requires (_Rows > 0 and _Cols > 0)
+    struct mat
+    {
+      _Tp _M_elems[_Rows][_Cols];
+
+      using value_type = _Tp;
+
+      static constexpr std::constexpr_wrapper<_Rows> rows{};
+
+      static constexpr std::constexpr_wrapper<_Cols> cols{};
+
+      constexpr _Tp&
+      operator()(std::size_t __r, std::size_t __c)
+      { return _M_elems[__r][__c]; }
+
+      constexpr const _Tp&
+      operator()(std::size_t __r, std::size_t __c) const
+      { return _M_elems[__r][__c]; }
+
+#if __cpp_multidimensional_subscript
+      constexpr _Tp&
+      operator[](std::size_t __r, std::size_t __c)
+      { return _M_elems[__r][__c]; }
+
+      constexpr const _Tp&
+      operator[](std::size_t __r, std::size_t __c) const
+      { return _M_elems[__r][__c]; }
+#endif
+
+      friend constexpr bool
+      operator==(const mat&, const mat&) = default;
+
+      friend constexpr mat
+      operator+(const mat& __a, const mat& __b)
+      {
+	mat __r;
+	for (std::size_t __i = 0; __i < _Rows; ++__i)
+	  for (std::size_t __j = 0; __j < _Cols; ++__j)
+	    __r._M_elems[__i][__j] = __a._M_elems[__i][__j] + __b._M_elems[__i][__j];
+	return __r;
+      }
+
+      friend constexpr mat
+      operator-(const mat& __a, const mat& __b)
+      {
+	mat __r;
+	for (std::size_t __i = 0; __i < _Rows; ++__i)
+	  for (std::size_t __j = 0; __j < _Cols; ++__j)
+	    __r._M_elems[__i][__j] = __a._M_elems[__i][__j] - __b._M_elems[__i][__j];
+	return __r;
+      }
+
+      friend constexpr mat
+      operator*(_Tp __s, const mat& __a)
+      {
+	mat __r;
+	for (std::size_t __i = 0; __i < _Rows; ++__i)
+	  for (std::size_t __j = 0; __j < _Cols; ++__j)
+	    __r._M_elems[__i][__j] = __s * __a._M_elems[__i][__j];
+	return __r;
+      }
+    };
+
+  // Value-initialized vector/matrix with dimensions given as constexpr_value:
+  //   auto m = vir::make_mat<float>(std::cw<3>, std::cw<3>);
+  template <typename _Tp, std::constexpr_value<std::size_t> _Np>
+    constexpr vec<_Tp, _Np::value>
+    make_vec(_Np)
+    { return {}; }
+
+  template <typename _Tp, std::constexpr_value<std::size_t> _Rows,
+	    std::constexpr_value<std::size_t> _Cols>
+    constexpr mat<_Tp, _Rows::value, _Cols::value>
+    make_mat(_Rows, _Cols)
+    { return {}; }
+
+  template <typename _Tp, std::constexpr_value<std::size_t> _Np>
+    constexpr mat<_Tp, _Np::value, _Np::value>
+    identity(_Np)
+    {
+      mat<_Tp, _Np::value, _Np::value> __r = {};
+      for (std::size_t __i = 0; __i < _Np::value; ++__i)
+	__r._M_elems[__i][__i] = _Tp(1);
+      return __r;
+    }
+
+  template <typename _Tp, std::size_t _Np>
+    constexpr _Tp
+    dot(const vec<_Tp, _Np>& __a, const vec<_Tp, _Np>& __b)
+    {
+      _Tp __r = __a[0] * __b[0];
+      __detail::__static_for<_Np - 1>([&](auto __i) { __r += __a[__i + 1] * __b[__i + 1]; });
+      return __r;
+    }
+
+  template <typename _Tp, std::size_t _Rows, std::size_t _Cols>
+    constexpr mat<_Tp, _Cols, _Rows>
+    transpose(const mat<_Tp, _Rows, _Cols>& __a)
+    {
+      mat<_Tp, _Cols, _Rows> __r;
+      if constexpr (_Rows * _Cols <= __detail::__linalg_unroll_max)
+	__detail::__static_for<_Rows>([&](auto __i) {
+	  __detail::__static_for<_Cols>([&](auto __j) {
+	    __r._M_elems[__j][__i] = __a._M_elems[__i][__j];
+	  });
+	});
+      else
+	{
+	  // blocked, so that both source and destination tiles stay in L1
+	  constexpr std::size_t __b = __detail::__linalg_block;
+	  for (std::size_t __ii = 0; __ii < _Rows; __ii += __b)
+	    for (std::size_t __jj = 0; __jj < _Cols; __jj += __b)
+	      for (std::size_t __i = __ii; __i < __ii + __b and __i < _Rows; ++__i)
+		for (std::size_t __j = __jj; __j < __jj + __b and __j < _Cols; ++__j)
+		  __r._M_elems[__j][__i] = __a._M_elems[__i][__j];
+	}
+      return __r;
+    }
+
+  // Matrix product. For small shapes, every row of the result is computed as a sequence of
+  // row-vector updates `r[i][:] += a[i][k] * b[k][:]`, fully unrolled. The inner updates are
+  // independent across columns, which the compiler turns into vector multiply-adds (e.g. 4x4
+  // float: one broadcast and one FMA per k and row). Larger shapes use a blocked i-k-j loop nest.
+  template <typename _Tp, std::size_t _Rows, std::size_t _Inner, std::size_t _Cols>
+    constexpr mat<_Tp, _Rows, _Cols>
+    operator*(const mat<_Tp, _Rows, _Inner>& __a, const mat<_Tp, _Inner, _Cols>& __b)
+    {
+      mat<_Tp, _Rows, _Cols> __r;
+      if constexpr (_Rows * _Inner * _Cols <= __detail::__linalg_unroll_max)
+	__detail::__static_for<_Rows>([&](auto __i) {
+	  __detail::__static_for<_Cols>([&](auto __j) {
+	    __r._M_elems[__i][__j] = __a._M_elems[__i][0] * __b._M_elems[0][__j];
+	  });
+	  __detail::__static_for<_Inner - 1>([&](auto __k) {
+	    __detail::__static_for<_Cols>([&](auto __j) {
+	      __r._M_elems[__i][__j] += __a._M_elems[__i][__k + 1] * __b._M_elems[__k + 1][__j];
+	    });
+	  });
+	});
+      else
+	{
+	  constexpr std::size_t __bs = __detail::__linalg_block;
+	  for (std::size_t __i = 0; __i < _Rows; ++__i)
+	    for (std::size_t __j = 0; __j < _Cols; ++__j)
+	      __r._M_elems[__i][__j] = _Tp();
+	  for (std::size_t __ii = 0; __ii < _Rows; __ii += __bs)
+	    for (std::size_t __kk = 0; __kk < _Inner; __kk += __bs)
+	      for (std::size_t __jj = 0; __jj < _Cols; __jj += __bs)
+		for (std::size_t __i = __ii; __i < __ii + __bs and __i < _Rows; ++__i)
+		  for (std::size_t __k = __kk; __k < __kk + __bs and __k < _Inner; ++__k)
+		    {
+		      const _Tp __aik = __a._M_elems[__i][__k];
+		      for (std::size_t __j = __jj; __j < __jj + __bs and __j < _Cols; ++__j)
+			__r._M_elems[__i][__j] += __aik * __b._M_elems[__k][__j];
+		    }
+	}
+      return __r;
+    }
+
+  template <typename _Tp, std::size_t _Rows, std::size_t _Cols>
+    constexpr vec<_Tp, _Rows>
+    operator*(const mat<_Tp, _Rows, _Cols>& __a, const vec<_Tp, _Cols>& __x)
+    {
+      vec<_Tp, _Rows> __r;
+      if constexpr (_Rows * _Cols <= __detail::__linalg_unroll_max)
+	{
+	  // column-wise updates `r += a[:][k] * x[k]`: independent across rows, like operator*
+	  // above
+	  __detail::__static_for<_Rows>([&](auto __i) {
+	    __r[__i] = __a._M_elems[__i][0] * __x[0];
+	  });
+	  __detail::__static_for<_Cols - 1>([&](auto __k) {
+	    __detail::__static_for<_Rows>([&](auto __i) {
+	      __r[__i] += __a._M_elems[__i][__k + 1] * __x[__k + 1];
+	    });
+	  });
+	}
+      else
+	for (std::size_t __i = 0; __i < _Rows; ++__i)
+	  {
+	    _Tp __sum = __a._M_elems[__i][0] * __x[0];
+	    for (std::size_t __k = 1; __k < _Cols; ++__k)
+	      __sum += __a._M_elems[__i][__k] * __x[__k];
+	    __r[__i] = __sum;
+	  }
+      return __r;
+    }
+}
+
+#endif  // VIR_CW_LINALG_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_MATH_HPP_
+#define VIR_CW_MATH_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    // Exponents up to this value use a shortest addition chain (found by search at compile time,
+    // a few ms per exponent); larger exponents use the left-to-right binary method, which needs at
+    // most one multiplication per set bit more. The search cost grows quickly beyond 128 (seconds
+    // for some exponents in [192, 1024]).
+    inline constexpr unsigned long long __pow_chain_search_max = 128;
+
+    // Star (Brauer) addition chain 1 = e[0] < e[1] < ... < e[len] = n, where every element is
+    // e[k + 1] = e[k] + e[rhs[k]]. For n < 12509 the shortest star chain is a shortest addition
+    // chain.
+    struct __addition_chain
+    {
+      static constexpr int _S_capacity = 128;
+
+      int _M_len = 0;
+      unsigned long long _M_elems[_S_capacity + 1] = {1};
+      int _M_rhs[_S_capacity] = {};
+    };
+
+    // Depth-first search for a chain of exactly __len steps, starting at step __k.
+    consteval bool
+    __chain_search(__addition_chain& __c, int __k, int __len, unsigned long long __n)
+    {
+      const unsigned long long __last = __c._M_elems[__k];
+      if (__last == __n)
+	{
+	  __c._M_len = __k;
+	  return true;
+	}
+      // not even doubling in every remaining step reaches __n
+      if (__k == __len or (__last << (__len - __k)) < __n)
+	return false;
+      for (int __j = __k; __j >= 0; --__j)
+	{
+	  const unsigned long long __next = __last + __c._M_elems[__j];
+	  if (__next > __n)
+	    continue;
+	  __c._M_elems[__k + 1] = __next;
+	  __c._M_rhs[__k] = __j;
+	  if (__chain_search(__c, __k + 1, __len, __n))
+	    return true;
+	}
+      return false;
+    }
+
+    consteval __addition_chain
+    __make_addition_chain(unsigned long long __n)
+    {
+      __addition_chain __c = {};
+      if (__n <= 1)
+	return __c;
+      if (__n <= __pow_chain_search_max)
+	{
+	  // iterative deepening: the first chain found is a shortest one
+	  for (int __len = std::bit_width(__n) - 1;; ++__len)
+	    if (__chain_search(__c, 0, __len, __n))
+	      return __c;
+	}
+      // left-to-right binary: square for every bit, multiply by x for every set bit
+      for (int __bit = std::bit_width(__n) - 2; __bit >= 0; --__bit)
+	{
+	  const int __k = __c._M_len;
+	  __c._M_elems[__k + 1] = __c._M_elems[__k] * 2;
+	  __c._M_rhs[__k] = __k;
+	  ++__c._M_len;
+	  if ((__n >> __bit) & 1)
+	    {
+	      __c._M_elems[__k + 2] = __c._M_elems[__k + 1] + 1;
+	      __c._M_rhs[__k + 1] = 0;
+	      ++__c._M_len;
+	    }
+	}
+      return __c;
+    }
+
+    template <unsigned long long _Np>
+      inline constexpr __addition_chain __pow_chain = __make_addition_chain(_Np);
+
+    // x^_Np in __pow_chain<_Np>._M_len multiplications. Every intermediate is kept (the chain may
+    // refer back to any of them); the compiler only keeps the ones that are used again.
+    template <unsigned long long _Np, typename _Tp>
+      [[gnu::always_inline]] constexpr _Tp
+      __pow_unsigned(const _Tp& __x)
+      {
+	constexpr __addition_chain __c = __pow_chain<_Np>;
+	return [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	  _Tp __v[] = {(void(_Is), __x)...};
+	  [&]<std::size_t... _Ks>(std::index_sequence<_Ks...>) {
+	    ((__v[_Ks + 1] = _Tp(__v[_Ks] * __v[__c._M_rhs[_Ks]])), ...);
+	  }(std::make_index_sequence<__c._M_len>());
+	  return __v[__c._M_len];
+	}(std::make_index_sequence<__c._M_len + 1>());
+      }
+
+    template <typename _Tp>
+      consteval _Tp
+      __isqrt(_Tp __x)
+      {
+	// Newton iteration from above, in the unsigned type to avoid overflow of __r + 1
+	using _Up = std::make_unsigned_t<_Tp>;
+	const _Up __u = static_cast<_Up>(__x);
+	if (__u < 2)
+	  return __x;
+	_Up __r = _Up(1) << ((std::bit_width(__u) + 1) / 2);
+	for (_Up __next = (__r + __u / __r) / 2; __next < __r; __next = (__r + __u / __r) / 2)
+	  __r = __next;
+	return static_cast<_Tp>(__r);
+      }
+  }
+
+  // x^n for runtime x and a constant integral exponent, computed with a shortest addition chain
+  // of multiplications: x⁵ = (x²)² x, x⁷ = ((x²)x)² x, x¹⁵ = ((x²x)²)² (x²x) (5 instead of the 6
+  // multiplies of square-and-multiply). A negative exponent computes 1 / x^-n (not for integral
+  // x). x can be any type with a multiplication operator, e.g. std::simd.
+  template <typename _Tp, std::constexpr_value _Np>
+    requires (not std::constexpr_value<_Tp> and std::integral<typename _Np::value_type>
+		and (_Np::value >= 0 or not std::integral<_Tp>))
+    constexpr _Tp
+    pow(const _Tp& __x, _Np)
+    {
+      constexpr auto __n = _Np::value;
+      if constexpr (__n == 0)
+	return _Tp(1);
+      else if constexpr (__n < 0)
+	return _Tp(1)
+		 / __detail::__pow_unsigned<0ull - static_cast<unsigned long long>(__n)>(__x);
+      else
+	return __detail::__pow_unsigned<static_cast<unsigned long long>(__n)>(__x);
+    }
+
+  // a^b for constant a and b, as a constant: `vir::pow(std::cw<2>, std::cw<10>)` is
+  // `constexpr_wrapper<1024>`. Signed overflow is a compile error.
+  template <std::constexpr_value _Ap, std::constexpr_value _Np>
+    requires std::integral<typename _Np::value_type>
+	       and (_Np::value >= 0 or not std::integral<typename _Ap::value_type>)
+    constexpr auto
+    pow(_Ap, _Np)
+    { return std::cw<vir::pow(_Ap::value, _Np())>; }
+
+  // Integral functions of constants, yielding constants.
+
+  // floor(sqrt(x)), with the type of x
+  template <std::constexpr_value _Np>
+    requires std::integral<typename _Np::value_type> and (_Np::value >= 0)
+    constexpr auto
+    sqrt(_Np)
+    { return std::cw<__detail::__isqrt(_Np::value)>; }
+
+  // floor(log2(x)) as int
+  template <std::constexpr_value _Np>
+    requires std::integral<typename _Np::value_type> and (_Np::value > 0)
+    constexpr auto
+    log2(_Np)
+    {
+      return std::cw<int(std::bit_width(std::make_unsigned_t<typename _Np::value_type>(
+				      _Np::value))) - 1>;
+    }
+
+  // number of set bits (of the two's complement representation for signed types) as int
+  template <std::constexpr_value _Np>
+    requires std::integral<typename _Np::value_type>
+    constexpr auto
+    popcount(_Np)
+    {
+      return std::cw<std::popcount(std::make_unsigned_t<typename _Np::value_type>(
+			 _Np::value))>;
+    }
+
+  // number of bits needed to represent x (of the two's complement representation for signed
+  // types) as int
+  template <std::constexpr_value _Np>
+    requires std::integral<typename _Np::value_type>
+    constexpr auto
+    bit_width(_Np)
+    {
+      return std::cw<int(std::bit_width(std::make_unsigned_t<typename _Np::value_type>(
+				  _Np::value)))>;
+    }
+}
+
+#endif  // VIR_CW_MATH_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,207 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_MEMO_HPP_
+#define VIR_CW_MEMO_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <array>
+#include <charconv>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace vir
+{
+  // The result of _Fn(_Args...), evaluated at compile time once per TU (the variable template is
+  // instantiated once per distinct key, no matter how many expressions use it). Being an inline
+  // variable, there is also only one object in the program, e.g. for a large table.
+  //
+  // To evaluate it once per build instead, generate explicit specializations with
+  // vir::memo_specialization (see below).
+  template <auto _Fn, auto... _Args>
+    inline constexpr auto memo_v = std::invoke(_Fn, _Args...);
+
+  // A reference to memo_v for a wrapped function (pointer or captureless lambda) and wrapped
+  // arguments:
+  //   constexpr auto& primes = vir::memo(std::cw<&make_sieve>, std::cw<1u << 18>);
+  template <auto _Fn, std::constexpr_value... _Args>
+    constexpr const auto&
+    memo(std::constexpr_wrapper<_Fn>, _Args...)
+    { return memo_v<_Fn, _Args::value...>; }
+
+  namespace __detail
+  {
+    template <auto _Fn, auto... _Args>
+      using __memo_result_t
+	= std::remove_cvref_t<std::invoke_result_t<decltype(_Fn), decltype(_Args)...>>;
+
+    template <typename _Tp>
+      struct __is_std_array
+      : std::false_type
+      {};
+
+    template <typename _Tp, std::size_t _Np>
+      struct __is_std_array<std::array<_Tp, _Np>>
+      : std::true_type
+      {};
+
+    // The element type of (nested) std::arrays.
+    template <typename _Tp>
+      struct __memo_scalar
+      { using type = _Tp; };
+
+    template <typename _Tp, std::size_t _Np>
+      struct __memo_scalar<std::array<_Tp, _Np>>
+      : __memo_scalar<_Tp>
+      {};
+
+    template <typename _Tp>
+      using __memo_scalar_t = typename __memo_scalar<_Tp>::type;
+
+    template <typename _Tp>
+      constexpr void
+      __memo_append_unsigned(std::string& __out, _Tp __x)
+      {
+	char __buf[3 * sizeof(_Tp) + 1];
+	char* __p = __buf + sizeof(__buf);
+	do
+	  {
+	    *--__p = char('0' + __x % 10);
+	    __x /= 10;
+	  }
+	while (__x != 0);
+	__out.append(__p, __buf + sizeof(__buf));
+      }
+
+    // Appends the elements of __x (arrays flattened; nested std::arrays are initialized by brace
+    // elision) as a comma-separated list. Enumerators are written as casts to _Ep (declared by
+    // memo_specialization). Floating-point values are written as hexadecimal literals with the
+    // suffix of their type, which round-trip exactly.
+    template <typename _Tp>
+      constexpr void
+      __memo_append(std::string& __out, const _Tp& __x)
+      {
+	if constexpr (__is_std_array<_Tp>::value)
+	  {
+	    for (std::size_t __i = 0; __i < __x.size(); ++__i)
+	      {
+		if (__i != 0)
+		  __out += ", ";
+		__memo_append(__out, __x[__i]);
+	      }
+	  }
+	else if constexpr (std::is_same_v<_Tp, bool>)
+	  __out += __x ? "true" : "false";
+	else if constexpr (std::is_enum_v<_Tp>)
+	  {
+	    __out += "_Ep(";
+	    __memo_append(__out, std::to_underlying(__x));
+	    __out += ')';
+	  }
+	else if constexpr (std::is_integral_v<_Tp>)
+	  {
+	    using _Up = std::make_unsigned_t<_Tp>;
+	    if (__x < _Tp())
+	      {
+		// written as (-1 - n) to also cover the minimum value
+		__out += "(-1-";
+		__memo_append_unsigned(__out, _Up(-(__x + 1)));
+		__out += ')';
+	      }
+	    else
+	      __memo_append_unsigned(__out, _Up(__x));
+	  }
+	else if constexpr (std::is_floating_point_v<_Tp>)
+	  {
+	    // the suffix of the literal and of the builtin (e.g. 0x1p-1L, __builtin_nanl)
+	    constexpr std::string_view __suffix = std::is_same_v<_Tp, float> ? "f"
+						    : std::is_same_v<_Tp, double> ? "" : "L";
+	    constexpr std::string_view __fn_suffix = std::is_same_v<_Tp, float> ? "f"
+						       : std::is_same_v<_Tp, double> ? "" : "l";
+	    if (__x != __x)
+	      {
+		__out += "__builtin_nan";
+		__out += __fn_suffix;
+		__out += "(\"\")";
+	      }
+	    else if (__x - __x != _Tp())  // inf - inf is NaN
+	      {
+		__out += __x < 0 ? "-__builtin_huge_val" : "__builtin_huge_val";
+		__out += __fn_suffix;
+		__out += "()";
+	      }
+	    else
+	      {
+		char __buf[64];
+		const auto [__end, __ec] = std::to_chars(__buf, __buf + sizeof(__buf), __x,
+							  std::chars_format::hex);
+		std::string_view __s(__buf, __end);
+		if (__s.starts_with('-'))
+		  {
+		    __out += '-';
+		    __s.remove_prefix(1);
+		  }
+		__out += "0x";
+		__out += __s;
+		__out += __suffix;
+	      }
+	  }
+	else
+	  static_assert(std::is_arithmetic_v<_Tp>,
+			"memo_specialization supports arithmetic and enum types and std::arrays "
+			"thereof");
+      }
+  }
+
+  // The C++ source of an explicit specialization of memo_v<_Fn, _Args...> that is initialized
+  // with the result of _Fn(_Args...), computed by calling _Fn at run time (i.e. at native speed
+  // instead of in the constant evaluator). __key is the spelling of the template arguments in the
+  // generated header. A generator program for a table used in many TUs:
+  //   #include "tables.hpp"  // declares constexpr std::array<...> make_sieve(unsigned)
+  //   #include <iostream>
+  //   int main()
+  //   { std::cout << vir::memo_specialization<&make_sieve, 1u << 18>("&make_sieve, 1u << 18"); }
+  // Its output must be included before any use of memo_v in every TU, e.g. by tables.hpp itself,
+  // after the declaration of make_sieve (with __has_include, so that the generated header is
+  // optional). Then the TUs parse a literal instead of evaluating make_sieve. `make bench-memo`
+  // shows the difference.
+  template <auto _Fn, auto... _Args>
+    constexpr std::string
+    memo_specialization(std::string_view __key)
+    {
+      using _Rp = __detail::__memo_result_t<_Fn, _Args...>;
+      const _Rp __value = std::invoke(_Fn, _Args...);
+      std::string __out = "template <>\n  inline constexpr auto vir::memo_v<";
+      __out += __key;
+      if constexpr (std::is_enum_v<__detail::__memo_scalar_t<_Rp>>)
+	{
+	  // enumerators need an explicit conversion, which needs a short name for the enum type
+	  __out += ">\n    = [] {\n      using _Ep = vir::__detail::__memo_scalar_t<"
+		   "vir::__detail::__memo_result_t<";
+	  __out += __key;
+	  __out += ">>;\n      return vir::__detail::__memo_result_t<";
+	  __out += __key;
+	  __out += ">{";
+	  __detail::__memo_append(__out, __value);
+	  __out += "};\n    }();\n";
+	}
+      else
+	{
+	  __out += ">\n    = vir::__detail::__memo_result_t<";
+	  __out += __key;
+	  __out += ">{";
+	  __detail::__memo_append(__out, __value);
+	  __out += "};\n";
+	}
+      return __out;
+    }
+}
+
+#endif  // VIR_CW_MEMO_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,257 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_MEMORY_HPP_
+#define VIR_CW_MEMORY_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    // Largest block that is moved with a single (unaligned) load/store pair.
+#if defined __AVX512F__
+    inline constexpr std::size_t __cw_mem_block = 64;
+#elif defined __AVX__
+    inline constexpr std::size_t __cw_mem_block = 32;
+#elif defined __SSE2__ or defined __ARM_NEON
+    inline constexpr std::size_t __cw_mem_block = 16;
+#else
+    inline constexpr std::size_t __cw_mem_block = sizeof(void*);
+#endif
+
+    // Sizes above this are handed to libc (still with a constant size argument).
+    inline constexpr std::size_t __cw_mem_inline_max = 8 * __cw_mem_block;
+
+    // The same for cw_memcmp. Every word of a compare is a serially dependent load/compare/branch
+    // step (not a block move), so only up to 4 words are inlined.
+    inline constexpr std::size_t __cw_cmp_inline_max = 32;
+
+    // A single move (fill) of _Np bytes. In constant evaluation (where __builtin_memcpy and
+    // __builtin_memset are not usable on arbitrary bytes) a byte loop, so that the block
+    // decomposition below can be checked with static_assert.
+    template <std::size_t _Np>
+      [[gnu::always_inline]] constexpr void
+      __cw_move(unsigned char* __dst, const unsigned char* __src)
+      {
+	if consteval
+	  {
+	    for (std::size_t __i = 0; __i < _Np; ++__i)
+	      __dst[__i] = __src[__i];
+	  }
+	else
+	  {
+	    __builtin_memcpy(__dst, __src, _Np);
+	  }
+      }
+
+    template <std::size_t _Np>
+      [[gnu::always_inline]] constexpr void
+      __cw_fill(unsigned char* __dst, unsigned char __c)
+      {
+	if consteval
+	  {
+	    for (std::size_t __i = 0; __i < _Np; ++__i)
+	      __dst[__i] = __c;
+	  }
+	else
+	  {
+	    __builtin_memset(__dst, __c, _Np);
+	  }
+      }
+
+    // Copies _Np bytes using only power-of-2 sized moves. Sizes that are not a power of 2 are
+    // covered with two overlapping moves (e.g. 12 = 8 @ 0 + 8 @ 4, 24 = 16 @ 0 + 16 @ 8), which is
+    // what hand-written fixed-size copies do.
+    template <std::size_t _Np>
+      [[gnu::always_inline]] constexpr void
+      __cw_copy(unsigned char* __dst, const unsigned char* __src)
+      {
+	if constexpr (_Np == 0)
+	  return;
+	else if constexpr (std::has_single_bit(_Np) and _Np <= __cw_mem_block)
+	  __cw_move<_Np>(__dst, __src);
+	else if constexpr (_Np < __cw_mem_block)
+	  {
+	    constexpr std::size_t __b = std::bit_floor(_Np);
+	    __cw_move<__b>(__dst, __src);
+	    __cw_move<__b>(__dst + _Np - __b, __src + _Np - __b);
+	  }
+	else
+	  {
+	    constexpr std::size_t __blocks = _Np / __cw_mem_block;
+	    [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	      (__cw_move<__cw_mem_block>(__dst + _Is * __cw_mem_block,
+					 __src + _Is * __cw_mem_block), ...);
+	    }(std::make_index_sequence<__blocks>());
+	    if constexpr (_Np % __cw_mem_block != 0)
+	      __cw_move<__cw_mem_block>(__dst + _Np - __cw_mem_block, __src + _Np - __cw_mem_block);
+	  }
+      }
+
+    template <std::size_t _Np>
+      [[gnu::always_inline]] constexpr void
+      __cw_set(unsigned char* __dst, unsigned char __c)
+      {
+	if constexpr (_Np == 0)
+	  return;
+	else if constexpr (std::has_single_bit(_Np) and _Np <= __cw_mem_block)
+	  __cw_fill<_Np>(__dst, __c);
+	else if constexpr (_Np < __cw_mem_block)
+	  {
+	    constexpr std::size_t __b = std::bit_floor(_Np);
+	    __cw_fill<__b>(__dst, __c);
+	    __cw_fill<__b>(__dst + _Np - __b, __c);
+	  }
+	else
+	  {
+	    constexpr std::size_t __blocks = _Np / __cw_mem_block;
+	    [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	      (__cw_fill<__cw_mem_block>(__dst + _Is * __cw_mem_block, __c), ...);
+	    }(std::make_index_sequence<__blocks>());
+	    if constexpr (_Np % __cw_mem_block != 0)
+	      __cw_fill<__cw_mem_block>(__dst + _Np - __cw_mem_block, __c);
+	  }
+      }
+
+    // Loads _Np (1, 2, 4, or 8) bytes such that an unsigned comparison of the result matches the
+    // lexicographical order of the bytes.
+    template <std::size_t _Np>
+      [[gnu::always_inline]] constexpr auto
+      __cw_load_ordered(const unsigned char* __p)
+      {
+	using _Up = std::conditional_t<
+		      _Np == 1, std::uint8_t,
+		      std::conditional_t<
+			_Np == 2, std::uint16_t,
+			std::conditional_t<_Np == 4, std::uint32_t, std::uint64_t>>>;
+	_Up __r = 0;
+	if consteval
+	  {
+	    for (std::size_t __i = 0; __i < _Np; ++__i)
+	      __r = _Up(__r << 8 | __p[__i]);
+	    return __r;
+	  }
+	__builtin_memcpy(&__r, __p, _Np);
+	if constexpr (std::endian::native == std::endian::little)
+	  {
+	    if constexpr (_Np == 2)
+	      __r = __builtin_bswap16(__r);
+	    else if constexpr (_Np == 4)
+	      __r = __builtin_bswap32(__r);
+	    else if constexpr (_Np == 8)
+	      __r = __builtin_bswap64(__r);
+	  }
+	return __r;
+      }
+
+    // Compares _Np bytes in words of up to 8 bytes. As above, a trailing partial word is handled
+    // by an overlapping load; bytes compared twice were equal the first time, so the result is
+    // unaffected.
+    template <std::size_t _Np>
+      [[gnu::always_inline]] constexpr int
+      __cw_compare(const unsigned char* __a, const unsigned char* __b)
+      {
+	constexpr std::size_t __w = _Np < 8 ? std::bit_floor(_Np) : 8;
+	int __r = 0;
+	auto __cmp = [&](std::size_t __off) {
+	  const auto __x = __cw_load_ordered<__w>(__a + __off);
+	  const auto __y = __cw_load_ordered<__w>(__b + __off);
+	  __r = (__x > __y) - (__x < __y);
+	  return __r != 0;
+	};
+	if constexpr (_Np == 0)
+	  return 0;
+	else
+	  {
+	    [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	      (__cmp(_Is * __w) or ...) or (_Np % __w != 0 and __cmp(_Np - __w));
+	    }(std::make_index_sequence<_Np / __w>());
+	    return __r;
+	  }
+      }
+
+    // A constant size. A negative constant is rejected instead of being converted to a huge
+    // std::size_t (which the non-template overloads below would otherwise accept).
+    template <typename _Np>
+      concept __cw_mem_size = std::constexpr_value<_Np, std::size_t> and (_Np::value >= 0);
+
+    template <typename _Np>
+      concept __cw_mem_negative_size = std::constexpr_value<_Np, std::size_t> and (_Np::value < 0);
+  }
+
+  // cw_memcpy, cw_memset, and cw_memcmp are drop-in replacements for their libc counterparts. If
+  // the size is a constexpr_value, small sizes are expanded into unrolled block moves/compares
+  // (without any call or size-dependent branch), larger sizes call libc with a constant size. A
+  // runtime size simply calls libc. A negative constant size does not compile.
+  template <__detail::__cw_mem_size _Np>
+    [[gnu::always_inline]] inline void*
+    cw_memcpy(void* __dst, const void* __src, _Np)
+    {
+      if constexpr (_Np::value <= __detail::__cw_mem_inline_max)
+	__detail::__cw_copy<_Np::value>(static_cast<unsigned char*>(__dst),
+					static_cast<const unsigned char*>(__src));
+      else
+	std::memcpy(__dst, __src, _Np::value);
+      return __dst;
+    }
+
+  inline void*
+  cw_memcpy(void* __dst, const void* __src, std::size_t __n)
+  { return std::memcpy(__dst, __src, __n); }
+
+  template <__detail::__cw_mem_size _Np>
+    [[gnu::always_inline]] inline void*
+    cw_memset(void* __dst, int __c, _Np)
+    {
+      if constexpr (_Np::value <= __detail::__cw_mem_inline_max)
+	__detail::__cw_set<_Np::value>(static_cast<unsigned char*>(__dst),
+				       static_cast<unsigned char>(__c));
+      else
+	std::memset(__dst, __c, _Np::value);
+      return __dst;
+    }
+
+  inline void*
+  cw_memset(void* __dst, int __c, std::size_t __n)
+  { return std::memset(__dst, __c, __n); }
+
+  // Returns <0, 0, or >0 like memcmp (though not necessarily the same non-zero value).
+  template <__detail::__cw_mem_size _Np>
+    [[gnu::always_inline]] inline int
+    cw_memcmp(const void* __a, const void* __b, _Np)
+    {
+      if constexpr (_Np::value <= __detail::__cw_cmp_inline_max)
+	return __detail::__cw_compare<_Np::value>(static_cast<const unsigned char*>(__a),
+						  static_cast<const unsigned char*>(__b));
+      else
+	return std::memcmp(__a, __b, _Np::value);
+    }
+
+  inline int
+  cw_memcmp(const void* __a, const void* __b, std::size_t __n)
+  { return std::memcmp(__a, __b, __n); }
+
+  template <__detail::__cw_mem_negative_size _Np>
+    void*
+    cw_memcpy(void*, const void*, _Np) = delete;
+
+  template <__detail::__cw_mem_negative_size _Np>
+    void*
+    cw_memset(void*, int, _Np) = delete;
+
+  template <__detail::__cw_mem_negative_size _Np>
+    int
+    cw_memcmp(const void*, const void*, _Np) = delete;
+}
+
+#endif  // VIR_CW_MEMORY_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_PACK_HPP_
+#define VIR_CW_PACK_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace vir
+{
+  // A list of (constexpr_wrapper) types, manipulated as values:
+  //   constexpr auto p = vir::make_pack(std::cw<3>, std::cw<1>, std::cw<4>, std::cw<1>);
+  //   vir::filter(vir::unique(p), [](auto c) { return c > std::cw<2>; })  // pack<cw<3>, cw<4>>
+  //
+  // None of the algorithms below instantiate templates recursively; they are built from fold
+  // expressions, constant bool/index arrays, and O(1) pack indexing, so that the compile time
+  // grows linearly (unique: quadratically in cheap __is_same tests) with the pack size instead of
+  // with the instantiation depth. The algorithms that invoke a function pass default-constructed
+  // elements (constexpr_wrappers are empty, so this costs nothing).
+  template <typename... _Ts>
+    struct pack
+    {
+      static constexpr std::constexpr_wrapper<sizeof...(_Ts)> size{};
+    };
+
+  namespace __detail
+  {
+#if __has_builtin(__type_pack_element)
+    template <std::size_t _Ip, typename... _Ts>
+      using __pack_element_t = __type_pack_element<_Ip, _Ts...>;
+#else
+    template <std::size_t _Ip, typename _Tp>
+      struct __pack_leaf
+      { using type = _Tp; };
+
+    template <typename _Seq, typename... _Ts>
+      struct __pack_indexer;
+
+    template <std::size_t... _Is, typename... _Ts>
+      struct __pack_indexer<std::index_sequence<_Is...>, _Ts...>
+      : __pack_leaf<_Is, _Ts>...
+      {};
+
+    // overload resolution picks the unique base with the given index
+    template <std::size_t _Ip, typename _Tp>
+      __pack_leaf<_Ip, _Tp>
+      __pack_select(const __pack_leaf<_Ip, _Tp>&);
+
+    template <std::size_t _Ip, typename... _Ts>
+      using __pack_element_t = typename decltype(__pack_select<_Ip>(
+				 std::declval<__pack_indexer<std::index_sequence_for<_Ts...>,
+							     _Ts...>>()))::type;
+#endif
+
+    // The elements of _Ts... for which _Keep is true, in order.
+    template <auto _Keep, typename... _Ts>
+      constexpr auto
+      __pack_compact()
+      {
+	constexpr std::size_t __m = [] {
+	  std::size_t __n = 0;
+	  for (bool __k : _Keep)
+	    __n += __k;
+	  return __n;
+	}();
+	constexpr auto __idx = [] {
+	  std::array<std::size_t, __m> __r = {};
+	  std::size_t __j = 0;
+	  for (std::size_t __i = 0; __i < _Keep.size(); ++__i)
+	    if (_Keep[__i])
+	      __r[__j++] = __i;
+	  return __r;
+	}();
+	return [&]<std::size_t... _Js>(std::index_sequence<_Js...>) {
+	  return pack<__pack_element_t<__idx[_Js], _Ts...>...>();
+	}(std::make_index_sequence<__m>());
+      }
+
+    template <typename... _As>
+      struct __pack_cat
+      {
+	template <typename... _Bs>
+	  constexpr __pack_cat<_As..., _Bs...>
+	  operator+(pack<_Bs...>) const
+	  { return {}; }
+      };
+
+    // Left fold of __f over the elements, via a fold expression over operator<<.
+    template <typename _Fp, typename _Tp>
+      struct __pack_fold
+      {
+	_Fp& _M_f;
+	_Tp _M_acc;
+
+	template <typename _Up>
+	  constexpr auto
+	  operator<<(_Up __x) &&
+	  {
+	    using _Rp = decltype(_M_f(std::move(_M_acc), __x));
+	    return __pack_fold<_Fp, _Rp>{_M_f, _M_f(std::move(_M_acc), __x)};
+	  }
+      };
+
+    template <typename _Tp, typename... _Ts>
+      inline constexpr std::size_t __pack_find = [] {
+	constexpr bool __eq[] = {std::is_same_v<_Tp, _Ts>..., true};
+	std::size_t __i = 0;
+	while (not __eq[__i])
+	  ++__i;
+	return __i;
+      }();
+  }
+
+  template <typename... _Ts>
+    constexpr pack<_Ts...>
+    make_pack(_Ts...)
+    { return {}; }
+
+  // The element at index _Ip (a default-constructed object of that type).
+  template <typename... _Ts, std::constexpr_value<std::size_t> _Ip>
+    requires (_Ip::value < sizeof...(_Ts))
+    constexpr auto
+    at(pack<_Ts...>, _Ip)
+    { return __detail::__pack_element_t<_Ip::value, _Ts...>(); }
+
+  // The pack of the results of __f applied to every element.
+  template <typename... _Ts, typename _Fp>
+    constexpr auto
+    map(pack<_Ts...>, _Fp&& __f)
+    { return pack<decltype(__f(_Ts()))...>(); }
+
+  // The elements for which __pred returns a true constexpr_value<bool> (e.g. the result of a
+  // comparison of constexpr_wrappers).
+  template <typename... _Ts, typename _Fp>
+    requires (std::constexpr_value<std::invoke_result_t<_Fp&, _Ts>, bool> and ...)
+    constexpr auto
+    filter(pack<_Ts...>, _Fp&&)
+    {
+      constexpr std::array<bool, sizeof...(_Ts)> __keep
+	= {bool(std::invoke_result_t<_Fp&, _Ts>::value)...};
+      return __detail::__pack_compact<__keep, _Ts...>();
+    }
+
+  // __f(... __f(__f(__init, e0), e1) ..., en)
+  template <typename... _Ts, typename _Tp, typename _Fp>
+    constexpr auto
+    fold(pack<_Ts...>, _Tp __init, _Fp&& __f)
+    {
+      return (__detail::__pack_fold<_Fp, _Tp>{__f, std::move(__init)} << ... << _Ts())._M_acc;
+    }
+
+  // The index of the first element of type _Up, or size if there is none, as a constant.
+  template <typename... _Ts, typename _Up>
+    constexpr std::constexpr_wrapper<__detail::__pack_find<_Up, _Ts...>>
+    index_of(pack<_Ts...>, _Up)
+    { return {}; }
+
+  template <typename... _Ts, typename _Up>
+    constexpr std::constexpr_wrapper<__detail::__pack_find<_Up, _Ts...> < sizeof...(_Ts)>
+    contains(pack<_Ts...>, _Up)
+    { return {}; }
+
+  // The pack without repeated types; the first occurrence is kept.
+  template <typename... _Ts>
+    constexpr auto
+    unique(pack<_Ts...>)
+    {
+      constexpr std::array<bool, sizeof...(_Ts)> __keep = [] {
+	constexpr std::size_t __first[] = {__detail::__pack_find<_Ts, _Ts...>..., 0};
+	std::array<bool, sizeof...(_Ts)> __r = {};
+	for (std::size_t __i = 0; __i < sizeof...(_Ts); ++__i)
+	  __r[__i] = __first[__i] == __i;
+	return __r;
+      }();
+      return __detail::__pack_compact<__keep, _Ts...>();
+    }
+
+  template <typename... _Packs>
+    constexpr auto
+    concat(_Packs... __packs)
+    {
+      return []<typename... _Ts>(__detail::__pack_cat<_Ts...>) {
+	return pack<_Ts...>();
+      }((__detail::__pack_cat<>() + ... + __packs));
+    }
+
+  // The values of a pack of constexpr_values as a wrapped std::array of their common type, e.g.
+  // for a table that vir::sorted_index_of or vir::lower_bound can use.
+  template <std::constexpr_value... _Ts>
+    constexpr auto
+    to_array(pack<_Ts...>)
+    {
+      using _Vp = std::common_type_t<typename _Ts::value_type...>;
+      return std::cw<std::array<_Vp, sizeof...(_Ts)>{static_cast<_Vp>(_Ts::value)...}>;
+    }
+}
+
+#endif  // VIR_CW_PACK_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_POLYNOMIAL_HPP_
+#define VIR_CW_POLYNOMIAL_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    // The element type of x, i.e. the type coefficients are converted to. For scalar x this is
+    // the type of x; for vector types (e.g. std::simd) it is their value_type, so that the
+    // coefficient is broadcast instead of going through a (possibly non-value-preserving) double.
+    template <typename _Tp>
+      struct __poly_scalar
+      { using type = _Tp; };
+
+    template <typename _Tp>
+      requires requires { typename _Tp::value_type; }
+      struct __poly_scalar<_Tp>
+      { using type = typename _Tp::value_type; };
+
+    template <typename _Tp, typename _Cp>
+      constexpr _Tp
+      __poly_value(_Cp __c)
+      {
+	if constexpr (std::constexpr_value<_Cp>)
+	  return _Tp(static_cast<typename __poly_scalar<_Tp>::type>(_Cp::value));
+	else
+	  return __c;
+      }
+
+    // Addition and multiplication where either operand may be a constexpr_value. Constants are
+    // folded, and additions of 0 and multiplications by 0, 1, and -1 are elided. (Dropping `0 * x`
+    // is the point of the exercise, even though it differs for x = inf/NaN.)
+    template <typename _Tp, typename _Ap, typename _Bp>
+      constexpr auto
+      __poly_add(_Ap __a, _Bp __b)
+      {
+	if constexpr (std::constexpr_value<_Ap> and std::constexpr_value<_Bp>)
+	  return __a + __b;
+	else if constexpr (std::constexpr_value<_Ap>)
+	  {
+	    if constexpr (_Ap::value == 0)
+	      return __b;
+	    else
+	      return __poly_value<_Tp>(__a) + __b;
+	  }
+	else if constexpr (std::constexpr_value<_Bp>)
+	  return __poly_add<_Tp>(__b, __a);
+	else
+	  return __a + __b;
+      }
+
+    template <typename _Tp, typename _Ap, typename _Bp>
+      constexpr auto
+      __poly_mul(_Ap __a, _Bp __b)
+      {
+	if constexpr (std::constexpr_value<_Ap> and std::constexpr_value<_Bp>)
+	  return __a * __b;
+	else if constexpr (std::constexpr_value<_Ap>)
+	  {
+	    if constexpr (_Ap::value == 0)
+	      return std::cw<0>;
+	    else if constexpr (_Ap::value == 1)
+	      return __b;
+	    else if constexpr (_Ap::value == -1)
+	      return -__b;
+	    else
+	      return __poly_value<_Tp>(__a) * __b;
+	  }
+	else if constexpr (std::constexpr_value<_Bp>)
+	  return __poly_mul<_Tp>(__b, __a);
+	else
+	  return __a * __b;
+      }
+
+    // c0 + x * (c1 + x * (c2 + ...))
+    template <typename _Tp, typename _Xp, typename _C0, typename... _Cs>
+      constexpr auto
+      __horner(_Xp __x, _C0 __c0, _Cs... __cs)
+      {
+	if constexpr (sizeof...(_Cs) == 0)
+	  return __c0;
+	else
+	  return __poly_add<_Tp>(__c0, __poly_mul<_Tp>(__x, __horner<_Tp>(__x, __cs...)));
+      }
+
+    // (c0 + c1 x) + x² (c2 + c3 x) + x⁴ ((c4 + c5 x) + x² (c6 + c7 x)) + ...
+    // The pairs are independent, which shortens the dependency chain from n to log2(n)
+    // multiply-adds.
+    template <typename _Tp, typename _Xp, typename... _Cs>
+      constexpr auto
+      __estrin(_Xp __x, _Cs... __cs)
+      {
+	if constexpr (sizeof...(_Cs) == 1)
+	  return (__cs, ...);
+	else
+	  {
+	    constexpr std::size_t __n = sizeof...(_Cs);
+	    const std::tuple<_Cs...> __c(__cs...);
+	    auto __pair = [&]<std::size_t _Ip>(std::integral_constant<std::size_t, _Ip>) {
+	      if constexpr (_Ip + 1 < __n)
+		return __poly_add<_Tp>(std::get<_Ip>(__c),
+				       __poly_mul<_Tp>(std::get<_Ip + 1>(__c), __x));
+	      else
+		return std::get<_Ip>(__c);
+	    };
+	    return [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	      return __estrin<_Tp>(__poly_mul<_Tp>(__x, __x),
+				   __pair(std::integral_constant<std::size_t, 2 * _Is>())...);
+	    }(std::make_index_sequence<(__n + 1) / 2>());
+	  }
+      }
+
+    // Index of the highest non-zero coefficient (0 for the zero polynomial).
+    template <std::constexpr_value... _Cs>
+      inline constexpr std::size_t __poly_degree = [] {
+	std::size_t __d = 0;
+	std::size_t __i = 0;
+	((__d = _Cs::value != 0 ? __i : __d, ++__i), ...);
+	return __d;
+      }();
+
+    // Whether all coefficients at odd (_Odd = true) or even indices are zero.
+    template <bool _Odd, std::constexpr_value... _Cs>
+      inline constexpr bool __poly_zero_parity = [] {
+	std::size_t __i = 0;
+	bool __r = true;
+	((__r = __r and (_Cs::value == 0 or (__i % 2 == 1) != _Odd), ++__i), ...);
+	return __r;
+      }();
+
+    // Selects the coefficients at even/odd indices and calls __f with them.
+    template <bool _Odd, typename _Fp, typename... _Cs>
+      constexpr auto
+      __poly_split(_Fp&& __f, _Cs... __cs)
+      {
+	const std::tuple<_Cs...> __c(__cs...);
+	return [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	  return __f(std::get<2 * _Is + _Odd>(__c)...);
+	}(std::make_index_sequence<(sizeof...(_Cs) + not _Odd) / 2>());
+      }
+
+    // Highest degree that is evaluated with Horner's scheme. Beyond that, Estrin's scheme exposes
+    // more instruction-level parallelism than it costs in extra multiplies.
+    inline constexpr std::size_t __horner_max_degree = 3;
+  }
+
+  // Evaluates c0 + c1 x + c2 x² + ... for runtime (scalar or SIMD) x and constant coefficients.
+  // Zero terms are dropped, multiplications by ±1 are elided, purely even/odd polynomials are
+  // evaluated in x², and the evaluation scheme is chosen by (effective) degree.
+  template <typename _Tp, std::constexpr_value _C0, std::constexpr_value... _Cs>
+    constexpr _Tp
+    polyval(const _Tp& __x, _C0 __c0, _Cs... __cs)
+    {
+      constexpr std::size_t __deg = __detail::__poly_degree<_C0, _Cs...>;
+      if constexpr (__deg >= 2 and __detail::__poly_zero_parity<true, _C0, _Cs...>)
+	return __detail::__poly_split<false>([&](auto... __even) {
+		 return polyval(_Tp(__x * __x), __even...);
+	       }, __c0, __cs...);
+      else if constexpr (__deg >= 2 and __detail::__poly_zero_parity<false, _C0, _Cs...>)
+	return __detail::__poly_split<true>([&](auto... __odd) {
+		 return _Tp(__x * polyval(_Tp(__x * __x), __odd...));
+	       }, __c0, __cs...);
+      else
+	{
+	  const auto __r = [&] {
+	    if constexpr (__deg <= __detail::__horner_max_degree)
+	      return __detail::__horner<_Tp>(__x, __c0, __cs...);
+	    else
+	      return __detail::__estrin<_Tp>(__x, __c0, __cs...);
+	  }();
+	  return __detail::__poly_value<_Tp>(__r);
+	}
+    }
+
+  // Explicit scheme selection; the same constant folding applies.
+  template <typename _Tp, std::constexpr_value _C0, std::constexpr_value... _Cs>
+    constexpr _Tp
+    polyval_horner(const _Tp& __x, _C0 __c0, _Cs... __cs)
+    { return __detail::__poly_value<_Tp>(__detail::__horner<_Tp>(__x, __c0, __cs...)); }
+
+  template <typename _Tp, std::constexpr_value _C0, std::constexpr_value... _Cs>
+    constexpr _Tp
+    polyval_estrin(const _Tp& __x, _C0 __c0, _Cs... __cs)
+    { return __detail::__poly_value<_Tp>(__detail::__estrin<_Tp>(__x, __c0, __cs...)); }
+}
+
+#endif  // VIR_CW_POLYNOMIAL_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
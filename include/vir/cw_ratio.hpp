@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_RATIO_HPP_
+#define VIR_CW_RATIO_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <compare>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+
+namespace vir
+{
+  namespace __detail
+  {
+    // not constexpr: calling it in a constant expression is the diagnostic
+    [[noreturn]] inline void
+    __ratio_zero_denominator()
+    { __builtin_trap(); }
+  }
+
+  // Exact rational number, always in lowest terms with a positive denominator. Structural, so that
+  // `std::cw<vir::ratio(441, 480)>` is valid and the constexpr_wrapper operators compute exact
+  // results at compile time:
+  //   std::cw<vir::ratio(1, 3)> + std::cw<vir::ratio(1, 6)>  ->  constexpr_wrapper<ratio(1, 2)>
+  // Overflow of the intermediate products is undefined behavior, i.e. a compile error in constant
+  // expressions.
+  struct ratio
+  {
+    std::intmax_t num = 0;
+    std::intmax_t den = 1;
+
+    ratio() = default;
+
+    // Only integers convert implicitly; a floating-point value must not silently become a ratio.
+    template <std::integral _Ip>
+      constexpr
+      ratio(_Ip __n)
+      : num(__n), den(1)
+      {}
+
+    constexpr
+    ratio(std::intmax_t __n, std::intmax_t __d)
+    {
+      if (__d == 0)
+	__detail::__ratio_zero_denominator();
+      const std::intmax_t __g = std::gcd(__n, __d) * (__d < 0 ? -1 : 1);
+      num = __n / __g;
+      den = __d / __g;
+    }
+
+    // Nearest floating-point value (one rounding step if num and den are exactly representable).
+    template <std::floating_point _Fp>
+      explicit constexpr
+      operator _Fp() const
+      { return _Fp(num) / _Fp(den); }
+
+    // num/den * 2^__frac_bits rounded to nearest (ties away from zero).
+    constexpr std::intmax_t
+    to_fixed(int __frac_bits) const
+    {
+      const std::intmax_t __scaled = num * (std::intmax_t(1) << __frac_bits);
+      const std::intmax_t __half = den / 2;
+      return (__scaled < 0 ? __scaled - __half : __scaled + __half) / den;
+    }
+
+    friend constexpr bool
+    operator==(const ratio&, const ratio&) = default;
+
+    friend constexpr std::strong_ordering
+    operator<=>(const ratio& __a, const ratio& __b)
+    { return __a.num * __b.den <=> __b.num * __a.den; }
+
+    constexpr ratio
+    operator+() const
+    { return *this; }
+
+    constexpr ratio
+    operator-() const
+    { return ratio(-num, den); }
+
+    friend constexpr ratio
+    operator+(const ratio& __a, const ratio& __b)
+    {
+      const std::intmax_t __g = std::gcd(__a.den, __b.den);
+      return ratio(__a.num * (__b.den / __g) + __b.num * (__a.den / __g), __a.den / __g * __b.den);
+    }
+
+    friend constexpr ratio
+    operator-(const ratio& __a, const ratio& __b)
+    { return __a + -__b; }
+
+    // cross-reduce first, to keep the products small
+    friend constexpr ratio
+    operator*(const ratio& __a, const ratio& __b)
+    {
+      const std::intmax_t __g1 = std::gcd(__a.num, __b.den);
+      const std::intmax_t __g2 = std::gcd(__b.num, __a.den);
+      if (__g1 == 0 or __g2 == 0) // one of the numerators is 0
+	return ratio();
+      return ratio((__a.num / __g1) * (__b.num / __g2), (__a.den / __g2) * (__b.den / __g1));
+    }
+
+    friend constexpr ratio
+    operator/(const ratio& __a, const ratio& __b)
+    { return __a * ratio(__b.den, __b.num); }
+  };
+
+  namespace __detail
+  {
+    // The type of the intermediate __x * __r.num of scale() for integral _Tp (like __fixed_int in
+    // cw_fixed.hpp): 64 bits for _Tp of up to 32 bits and a numerator of up to 32 bits, otherwise
+    // 128 bits if available. Signed if _Tp is signed.
+    template <typename _Tp, ratio __r>
+      constexpr auto
+      __ratio_scale_int()
+      {
+	constexpr bool __sgn = std::is_signed_v<_Tp>;
+	if constexpr (sizeof(_Tp) <= 4 and __r.num >= INT32_MIN and __r.num <= INT32_MAX)
+	  return std::conditional_t<__sgn, std::int64_t, std::uint64_t>();
+#ifdef __SIZEOF_INT128__
+	else
+	  return std::conditional_t<__sgn, __int128, unsigned __int128>();
+#else
+	else
+	  return std::conditional_t<__sgn, std::intmax_t, std::uintmax_t>();
+#endif
+      }
+  }
+
+  // Multiplies __x by the constant ratio. Floating-point __x is multiplied by the nearest
+  // representable value of the ratio (no division at run time). Integral __x is multiplied by num
+  // and divided by den in a wider type (see __ratio_scale_int), so that the intermediate product
+  // does not overflow; the division by a constant compiles to a multiply-shift. Without __int128,
+  // a 64-bit __x * num must still fit into 64 bits. In any case the result must fit into _Tp
+  // (i.e. a ratio > 1 can overflow). A negative ratio requires a signed _Tp.
+  template <typename _Tp, std::constexpr_value<ratio> _Rp>
+    requires std::is_arithmetic_v<_Tp> and (std::is_signed_v<_Tp> or _Rp::value.num >= 0)
+    constexpr _Tp
+    scale(_Tp __x, _Rp)
+    {
+      constexpr ratio __r = _Rp::value;
+      if constexpr (std::floating_point<_Tp>)
+	{
+	  constexpr _Tp __factor = _Tp(__r);
+	  return __x * __factor;
+	}
+      else if constexpr (__r.den == 1)
+	return __x * static_cast<_Tp>(__r.num);
+      else
+	{
+	  using _Wp = decltype(__detail::__ratio_scale_int<_Tp, __r>());
+	  return static_cast<_Tp>(_Wp(__x) * _Wp(__r.num) / _Wp(__r.den));
+	}
+    }
+}
+
+#endif  // VIR_CW_RATIO_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
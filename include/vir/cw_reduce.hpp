@@ -0,0 +1,246 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_REDUCE_HPP_
+#define VIR_CW_REDUCE_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    // Width of the widest vector register the target has (for choosing the number of
+    // accumulators).
+#if defined __AVX512F__
+    inline constexpr std::size_t __reduce_register_bytes = 64;
+#elif defined __AVX__
+    inline constexpr std::size_t __reduce_register_bytes = 32;
+#elif defined __SSE2__ or defined __ARM_NEON
+    inline constexpr std::size_t __reduce_register_bytes = 16;
+#else
+    inline constexpr std::size_t __reduce_register_bytes = sizeof(void*);
+#endif
+
+    // Default number of independent accumulators: enough for four vector registers. An FP add has
+    // a latency of ~4 cycles and (at least) one issued per cycle, so four chains keep the adder
+    // busy, and every chain is one full register after vectorization.
+    template <typename _Tp>
+      inline constexpr std::size_t __reduce_accumulators
+	= std::is_arithmetic_v<_Tp> and sizeof(_Tp) < __reduce_register_bytes
+	    ? 4 * (__reduce_register_bytes / sizeof(_Tp)) : 4;
+
+    // Constant lengths up to this value are fully unrolled; larger ones keep a loop over blocks of
+    // accumulators (with a constant trip count). GCC packs the accumulators of the loop into
+    // vector registers, but not those of straight-line code: sum(x, cw<256>) of floats is 3x
+    // faster than a plain loop if unrolled, 9x if not.
+    inline constexpr std::size_t __reduce_unroll_max = 64;
+
+    // Written as the patterns that compile to minss/maxss, like the compare-exchange of the
+    // sorting networks. (GCC vectorizes them for floating-point types only with
+    // -ffinite-math-only -fno-signed-zeros; otherwise the accumulators are independent scalar
+    // chains.)
+    struct __min_op
+    {
+      template <typename _Tp>
+	constexpr _Tp
+	operator()(const _Tp& __a, const _Tp& __b) const
+	{ return __b < __a ? __b : __a; }
+    };
+
+    struct __max_op
+    {
+      template <typename _Tp>
+	constexpr _Tp
+	operator()(const _Tp& __a, const _Tp& __b) const
+	{ return __a < __b ? __b : __a; }
+    };
+
+    // op(..., op(__acc[0], __acc[_Kp / 2]), ...) as a balanced tree
+    template <std::size_t _Kp, typename _Tp, typename _Op>
+      [[gnu::always_inline]] constexpr _Tp
+      __reduce_tree(_Tp* __acc, _Op& __op)
+      {
+	if constexpr (_Kp == 1)
+	  return __acc[0];
+	else
+	  {
+	    constexpr std::size_t __h = _Kp / 2;
+	    [&]<std::size_t... _Js>(std::index_sequence<_Js...>)
+	      __attribute__((__always_inline__)) {
+	      ((__acc[_Js] = __op(__acc[_Js], __acc[_Js + (_Kp - __h)])), ...);
+	    }(std::make_index_sequence<__h>());
+	    return __reduce_tree<_Kp - __h>(__acc, __op);
+	  }
+      }
+
+    // Reduces __load(0), ..., __load(__n - 1) with __op, using _Kp accumulators, where
+    // accumulator j sees the elements j, j + _Kp, j + 2 * _Kp, ... Requires __n >= _Kp.
+    template <typename _Tp, std::size_t _Kp, typename _Np, typename _Load, typename _Op>
+      [[gnu::always_inline]] constexpr _Tp
+      __reduce_blocked(_Np __n, _Load& __load, _Op& __op)
+      {
+	return [&]<std::size_t... _Js>(std::index_sequence<_Js...>)
+	  __attribute__((__always_inline__)) {
+	  _Tp __acc[_Kp] = {_Tp(__load(_Js))...};
+	  auto __block = [&](std::size_t __i) __attribute__((__always_inline__)) {
+	    ((__acc[_Js] = __op(__acc[_Js], __load(__i + _Js))), ...);
+	  };
+	  if constexpr (std::constexpr_value<_Np>)
+	    {
+	      constexpr std::size_t __blocks = _Np::value / _Kp;
+	      constexpr std::size_t __tail = _Np::value % _Kp;
+	      if constexpr (_Np::value <= __reduce_unroll_max)
+		[&]<std::size_t... _Bs>(std::index_sequence<_Bs...>)
+		  __attribute__((__always_inline__)) {
+		  (__block((_Bs + 1) * _Kp), ...);
+		}(std::make_index_sequence<__blocks - 1>());
+	      else
+		for (std::size_t __i = _Kp; __i < __blocks * _Kp; __i += _Kp)
+		  __block(__i);
+	      [&]<std::size_t... _Ts>(std::index_sequence<_Ts...>)
+		__attribute__((__always_inline__)) {
+		((__acc[_Ts] = __op(__acc[_Ts], __load(__blocks * _Kp + _Ts))), ...);
+	      }(std::make_index_sequence<__tail>());
+	    }
+	  else
+	    {
+	      std::size_t __i = _Kp;
+	      for (; __i + _Kp <= __n; __i += _Kp)
+		__block(__i);
+	      for (std::size_t __j = 0; __i < __n; ++__i, ++__j)
+		__acc[__j] = __op(__acc[__j], __load(__i));
+	    }
+	  return __reduce_tree<_Kp>(__acc, __op);
+	}(std::make_index_sequence<_Kp>());
+      }
+
+    // _Kp is the number of accumulators the caller asked for (0: choose). The count is limited
+    // to a constant __n; a runtime __n smaller than _Kp is reduced with a single accumulator.
+    // There is no identity to return for __n == 0: a constant 0 does not satisfy __reduce_size,
+    // a runtime 0 is a precondition violation (checked with _GLIBCXX_ASSERTIONS and in constant
+    // evaluation).
+    template <typename _Tp, std::size_t _Kp, typename _Np, typename _Load, typename _Op>
+      [[gnu::always_inline]] constexpr _Tp
+      __reduce(_Np __n, _Load __load, _Op __op)
+      {
+	if constexpr (std::constexpr_value<_Np>)
+	  {
+	    constexpr std::size_t __n0 = _Np::value;
+	    // the default is rounded down to a power of 2 (whole vector registers)
+	    constexpr std::size_t __k0 = _Kp != 0 ? _Kp : __reduce_accumulators<_Tp>;
+	    constexpr std::size_t __n1 = _Kp != 0 ? __n0 : std::bit_floor(__n0);
+	    constexpr std::size_t __k = __k0 < __n1 ? __k0 : __n1;
+	    return __reduce_blocked<_Tp, __k>(__n, __load, __op);
+	  }
+	else
+	  {
+	    __glibcxx_assert(std::size_t(__n) > 0);
+	    constexpr std::size_t __k = _Kp != 0 ? _Kp : __reduce_accumulators<_Tp>;
+	    if (std::size_t(__n) >= __k)
+	      return __reduce_blocked<_Tp, __k>(std::size_t(__n), __load, __op);
+	    _Tp __r = __load(0);
+	    for (std::size_t __i = 1; __i < std::size_t(__n); ++__i)
+	      __r = __op(__r, __load(__i));
+	    return __r;
+	  }
+      }
+
+    template <typename _Np>
+      concept __reduce_size
+	= std::convertible_to<_Np, std::size_t>
+	    and (not std::constexpr_value<_Np> or requires { requires _Np::value > 0; });
+
+    template <typename _Kp>
+      concept __accumulator_count
+	= std::constexpr_value<_Kp, std::size_t> and requires { requires _Kp::value > 0; };
+  }
+
+  // Reduces the first __n elements of the contiguous range __r with the associative (and
+  // commutative) __op. The elements are distributed over several independent accumulators, which
+  // are combined pairwise at the end:
+  //   acc[j] = op(acc[j], r[i + j])  for j in [0, k)
+  // This reassociates the reduction, which the compiler may not do on its own (e.g. a
+  // floating-point sum under strict IEEE semantics is a single dependency chain of adds). With k
+  // independent chains it is both pipelined and vectorized.
+  //
+  // __n must be > 0 (a constexpr_value 0 does not compile): the result of an empty reduction would
+  // need an identity element of __op, which is not known here.
+  //
+  // If __n is a constexpr_value the reduction is fully unrolled (up to 64 elements). The number
+  // of accumulators can be given as constexpr_value __accumulators; the default is four vector
+  // registers worth of elements:
+  //   vir::reduce(x, std::cw<64>, std::plus<>())              // 16 accumulators with SSE
+  //   vir::reduce(x, n, std::multiplies<>(), std::cw<8uz>)  // 8 accumulators
+  template <std::ranges::contiguous_range _Rg, __detail::__reduce_size _Np, typename _Op>
+    constexpr std::ranges::range_value_t<_Rg>
+    reduce(const _Rg& __r, _Np __n, _Op __op)
+    {
+      const auto* __p = std::ranges::data(__r);
+      auto __load = [__p](std::size_t __i) __attribute__((__always_inline__)) { return __p[__i]; };
+      return __detail::__reduce<std::ranges::range_value_t<_Rg>, 0>(__n, __load, __op);
+    }
+
+  template <std::ranges::contiguous_range _Rg, __detail::__reduce_size _Np, typename _Op,
+	    __detail::__accumulator_count _Kp>
+    constexpr std::ranges::range_value_t<_Rg>
+    reduce(const _Rg& __r, _Np __n, _Op __op, _Kp)
+    {
+      const auto* __p = std::ranges::data(__r);
+      auto __load = [__p](std::size_t __i) __attribute__((__always_inline__)) { return __p[__i]; };
+      return __detail::__reduce<std::ranges::range_value_t<_Rg>, _Kp::value>(__n, __load, __op);
+    }
+
+  // Sum, minimum, and maximum of the first __n elements via reduce, with the same precondition
+  // __n > 0 (the minimum and maximum of an empty range do not exist; for the sum use e.g.
+  // `n == 0 ? T() : vir::sum(r, n)` if the range may be empty).
+  template <std::ranges::contiguous_range _Rg, __detail::__reduce_size _Np,
+	    __detail::__accumulator_count... _Kp>
+    requires (sizeof...(_Kp) <= 1)
+    constexpr std::ranges::range_value_t<_Rg>
+    sum(const _Rg& __r, _Np __n, _Kp... __k)
+    { return vir::reduce(__r, __n, std::plus<>(), __k...); }
+
+  template <std::ranges::contiguous_range _Rg, __detail::__reduce_size _Np,
+	    __detail::__accumulator_count... _Kp>
+    requires (sizeof...(_Kp) <= 1)
+    constexpr std::ranges::range_value_t<_Rg>
+    min(const _Rg& __r, _Np __n, _Kp... __k)
+    { return vir::reduce(__r, __n, __detail::__min_op(), __k...); }
+
+  template <std::ranges::contiguous_range _Rg, __detail::__reduce_size _Np,
+	    __detail::__accumulator_count... _Kp>
+    requires (sizeof...(_Kp) <= 1)
+    constexpr std::ranges::range_value_t<_Rg>
+    max(const _Rg& __r, _Np __n, _Kp... __k)
+    { return vir::reduce(__r, __n, __detail::__max_op(), __k...); }
+
+  // Sum of the products of the first __n (> 0) elements of __a and __b, with the same accumulator
+  // scheme and precondition as reduce. (Every accumulator step is a multiply-add, contracted to an
+  // FMA where the target and -ffp-contract allow it.)
+  template <std::ranges::contiguous_range _Rg0, std::ranges::contiguous_range _Rg1,
+	    __detail::__reduce_size _Np, __detail::__accumulator_count... _Kp>
+    requires (sizeof...(_Kp) <= 1)
+    constexpr auto
+    dot(const _Rg0& __a, const _Rg1& __b, _Np __n, _Kp...)
+    {
+      const auto* __pa = std::ranges::data(__a);
+      const auto* __pb = std::ranges::data(__b);
+      using _Tp = decltype(__pa[0] * __pb[0]);
+      return __detail::__reduce<_Tp, (0 + ... + _Kp::value)>(
+	       __n, [__pa, __pb](std::size_t __i) __attribute__((__always_inline__)) {
+		 return __pa[__i] * __pb[__i]; },
+	       std::plus<>());
+    }
+}
+
+#endif  // VIR_CW_REDUCE_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_SELECT_HPP_
+#define VIR_CW_SELECT_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <functional>
+#include <utility>
+
+namespace vir
+{
+  // Calls __then_f() if __cond is true, __else_f() otherwise.
+  //
+  // If __cond is a constexpr_value (e.g. the result of `std::cw<N> < std::cw<M>`), only the taken
+  // branch is called, i.e. the other function (if it is a template, like a generic lambda) is
+  // never instantiated, and the two branches may return different types:
+  //   vir::cw_if(n < std::cw<8>, [&] { return small_kernel(x); }, [&] { return big_kernel(x); })
+  // For a runtime __cond the result is the common type of the two results.
+  template <typename _Cp, typename _Fp, typename _Gp>
+    requires std::convertible_to<_Cp, bool>
+    constexpr decltype(auto)
+    cw_if(_Cp __cond, _Fp&& __then_f, _Gp&& __else_f)
+    {
+      if constexpr (std::constexpr_value<_Cp, bool>)
+	{
+	  if constexpr (_Cp::value)
+	    return std::invoke(std::forward<_Fp>(__then_f));
+	  else
+	    return std::invoke(std::forward<_Gp>(__else_f));
+	}
+      else
+	{
+	  using _Rp = std::common_type_t<std::invoke_result_t<_Fp>, std::invoke_result_t<_Gp>>;
+	  if (__cond)
+	    return static_cast<_Rp>(std::invoke(std::forward<_Fp>(__then_f)));
+	  else
+	    return static_cast<_Rp>(std::invoke(std::forward<_Gp>(__else_f)));
+	}
+    }
+
+  template <typename _Cp, typename _Fp>
+    requires std::convertible_to<_Cp, bool>
+    constexpr void
+    cw_if(_Cp __cond, _Fp&& __then_f)
+    {
+      if constexpr (std::constexpr_value<_Cp, bool>)
+	{
+	  if constexpr (_Cp::value)
+	    std::invoke(std::forward<_Fp>(__then_f));
+	}
+      else if (__cond)
+	std::invoke(std::forward<_Fp>(__then_f));
+    }
+
+  // __a if __cond is true, __b otherwise.
+  //
+  // If __cond is a constexpr_value, the selected argument is returned unchanged (the two types
+  // may differ). For a runtime __cond the result is the common type; integers are selected with a
+  // mask instead of a (possibly mispredicted) branch.
+  template <typename _Cp, typename _Ap, typename _Bp>
+    requires std::convertible_to<_Cp, bool>
+    constexpr auto
+    select(_Cp __cond, const _Ap& __a, const _Bp& __b)
+    {
+      if constexpr (std::constexpr_value<_Cp, bool>)
+	{
+	  if constexpr (_Cp::value)
+	    return __a;
+	  else
+	    return __b;
+	}
+      else
+	{
+	  using _Rp = std::common_type_t<_Ap, _Bp>;
+	  if constexpr (std::integral<_Rp> and not std::same_as<_Rp, bool>)
+	    {
+	      const _Rp __x = __a;
+	      const _Rp __y = __b;
+	      // all ones if __cond, zero otherwise
+	      const _Rp __mask = _Rp(_Rp(0) - _Rp(bool(__cond)));
+	      return _Rp(__y ^ ((__x ^ __y) & __mask));
+	    }
+	  else
+	    return bool(__cond) ? _Rp(__a) : _Rp(__b);
+	}
+    }
+}
+
+#endif  // VIR_CW_SELECT_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
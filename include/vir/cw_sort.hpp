@@ -0,0 +1,315 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_SORT_HPP_
+#define VIR_CW_SORT_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    template <typename _Tp, std::size_t _Np>
+      consteval std::array<_Tp, _Np>
+      __insertion_sorted(std::array<_Tp, _Np> __a)
+      {
+	for (std::size_t __i = 1; __i < _Np; ++__i)
+	  for (std::size_t __j = __i; __j > 0 and __a[__j] < __a[__j - 1]; --__j)
+	    {
+	      const _Tp __tmp = __a[__j];
+	      __a[__j] = __a[__j - 1];
+	      __a[__j - 1] = __tmp;
+	    }
+	return __a;
+      }
+
+    template <typename _Rg>
+      consteval bool
+      __is_sorted(const _Rg& __r)
+      {
+	for (std::size_t __i = 1; __i < std::size(__r); ++__i)
+	  if (__r[__i] < __r[__i - 1])
+	    return false;
+	return true;
+      }
+
+    template <typename _Rg, typename _Key>
+      consteval std::size_t
+      __lower_bound_index(const _Rg& __r, const _Key& __key)
+      {
+	std::size_t __lo = 0;
+	std::size_t __hi = std::size(__r);
+	while (__lo < __hi)
+	  {
+	    const std::size_t __mid = __lo + (__hi - __lo) / 2;
+	    if (__r[__mid] < __key)
+	      __lo = __mid + 1;
+	    else
+	      __hi = __mid;
+	  }
+	return __lo;
+      }
+
+    // The sorted table in Eytzinger (BFS, implicit binary heap) order: the children of node k are
+    // 2k and 2k+1, node 0 is unused. The top levels of the tree share few cache lines, and the
+    // descent needs no data-dependent branch. _M_index maps node k back to the index in the
+    // sorted table, with _M_index[0] = size (no element is not less than the key).
+    template <typename _Tp, std::size_t _Np>
+      struct __eytzinger_layout
+      {
+	std::array<_Tp, _Np + 1> _M_elems = {};
+	std::array<std::size_t, _Np + 1> _M_index = {};
+
+	consteval
+	__eytzinger_layout(const auto& __sorted)
+	{
+	  std::size_t __i = 0;
+	  _M_fill(__sorted, __i, 1);
+	  _M_index[0] = _Np;
+	}
+
+	consteval void
+	_M_fill(const auto& __sorted, std::size_t& __i, std::size_t __k)
+	{
+	  if (__k > _Np)
+	    return;
+	  _M_fill(__sorted, __i, 2 * __k);
+	  _M_elems[__k] = __sorted[__i];
+	  _M_index[__k] = __i++;
+	  _M_fill(__sorted, __i, 2 * __k + 1);
+	}
+      };
+
+    template <std::constexpr_value _Table>
+      inline constexpr __eytzinger_layout<std::remove_cvref_t<decltype(_Table::value[0])>,
+					  std::size(_Table::value)>
+	__eytzinger = _Table::value;
+
+    // Tables larger than this (in bytes) prefetch the nodes four levels down, i.e. the 16
+    // consecutive elements (a cache line for 32-bit keys) that the search reaches after four
+    // more steps.
+    inline constexpr std::size_t __eytzinger_prefetch_min = 16 * 1024;
+
+    // Compare-exchange (__i, __j) with __i < __j: afterwards __s[__i] <= __s[__j].
+    struct __comparator
+    {
+      unsigned char _M_i;
+      unsigned char _M_j;
+    };
+
+    // Constant sizes up to this use a sorting network.
+    inline constexpr std::size_t __sorting_network_max = 32;
+
+    // Runtime sizes up to this use insertion sort, larger ones std::sort.
+    inline constexpr std::size_t __insertion_sort_max = 16;
+
+    template <std::size_t _Np>
+      struct __sorting_network
+      {
+	std::size_t _M_size = 0;
+	__comparator _M_cmp[_Np * _Np] = {};
+
+	consteval
+	__sorting_network(std::initializer_list<__comparator> __cmps)
+	{
+	  for (__comparator __c : __cmps)
+	    _M_cmp[_M_size++] = __c;
+	}
+
+	// Batcher's odd-even merge sort for the next power of two, without the comparators that
+	// refer to indexes >= _Np (as if those held +inf).
+	consteval
+	__sorting_network()
+	{
+	  for (std::size_t __p = 1; __p < _Np; __p *= 2)
+	    for (std::size_t __k = __p; __k >= 1; __k /= 2)
+	      for (std::size_t __j = __k % __p; __j + __k < _Np; __j += 2 * __k)
+		for (std::size_t __i = 0; __i < __k and __i + __j + __k < _Np; ++__i)
+		  if ((__i + __j) / (2 * __p) == (__i + __j + __k) / (2 * __p))
+		    _M_cmp[_M_size++] = {static_cast<unsigned char>(__i + __j),
+					 static_cast<unsigned char>(__i + __j + __k)};
+	}
+      };
+
+    // Networks with the minimal number of comparators for up to 10 elements (Knuth, TAOCP 5.3.4;
+    // the 9- and 10-element networks by Floyd and Waksman). Larger sizes use Batcher's
+    // construction, e.g. 25 elements: 140 comparators.
+    template <std::size_t _Np>
+      inline constexpr __sorting_network<_Np> __network = [] {
+	if constexpr (_Np == 2)
+	  return __sorting_network<2>{{0, 1}};
+	else if constexpr (_Np == 3)
+	  return __sorting_network<3>{{0, 2}, {0, 1}, {1, 2}};
+	else if constexpr (_Np == 4)
+	  return __sorting_network<4>{{0, 2}, {1, 3}, {0, 1}, {2, 3}, {1, 2}};
+	else if constexpr (_Np == 5)
+	  return __sorting_network<5>{{0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2},
+				      {3, 4}, {2, 3}};
+	else if constexpr (_Np == 6)
+	  return __sorting_network<6>{{0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3}, {2, 5},
+				      {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4}};
+	else if constexpr (_Np == 7)
+	  return __sorting_network<7>{{0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1},
+				      {2, 5}, {3, 4}, {1, 2}, {4, 6}, {2, 3}, {4, 5}, {1, 2},
+				      {3, 4}, {5, 6}};
+	else if constexpr (_Np == 8)
+	  return __sorting_network<8>{{0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6},
+				      {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5},
+				      {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+	else if constexpr (_Np == 9)
+	  return __sorting_network<9>{{0, 3}, {1, 7}, {2, 5}, {4, 8}, {0, 7}, {2, 4}, {3, 8},
+				      {5, 6}, {0, 2}, {1, 3}, {4, 5}, {7, 8}, {1, 4}, {3, 6},
+				      {5, 7}, {0, 1}, {2, 4}, {3, 5}, {6, 8}, {2, 3}, {4, 5},
+				      {6, 7}, {1, 2}, {3, 4}, {5, 6}};
+	else if constexpr (_Np == 10)
+	  return __sorting_network<10>{{0, 8}, {1, 9}, {2, 7}, {3, 5}, {4, 6}, {0, 2}, {1, 4},
+				       {5, 8}, {7, 9}, {0, 3}, {2, 4}, {5, 7}, {6, 9}, {0, 1},
+				       {3, 6}, {8, 9}, {1, 5}, {2, 3}, {4, 8}, {6, 7}, {1, 2},
+				       {3, 5}, {4, 6}, {7, 8}, {2, 3}, {4, 5}, {6, 7}, {3, 4},
+				       {5, 6}};
+	else
+	  return __sorting_network<_Np>();
+      }();
+
+    // Branchless: min/max (or conditional moves) instead of a data-dependent branch. The
+    // independent compare-exchanges of a network layer can be vectorized by the compiler.
+    template <typename _Tp>
+      [[gnu::always_inline]] constexpr void
+      __compare_exchange(_Tp& __a, _Tp& __b)
+      {
+	const _Tp __x = __a;
+	const _Tp __y = __b;
+	if constexpr (std::is_arithmetic_v<_Tp>)
+	  {
+	    // exactly the patterns of the min/max instructions (minss/maxss, pminsd/pmaxsd, ...);
+	    // for equal arguments both yield __y, which only matters for -0. vs. +0.
+	    __a = __x < __y ? __x : __y;
+	    __b = __y < __x ? __x : __y;
+	  }
+	else
+	  {
+	    // equivalent elements must be permuted, not duplicated
+	    const bool __swap = __y < __x;
+	    __a = __swap ? __y : __x;
+	    __b = __swap ? __x : __y;
+	  }
+      }
+
+    template <typename _Np>
+      consteval bool
+      __use_sorting_network()
+      {
+	if constexpr (std::constexpr_value<_Np>)
+	  return _Np::value <= __sorting_network_max;
+	else
+	  return false;
+      }
+
+    template <typename _Tp>
+      constexpr void
+      __insertion_sort(_Tp* __first, std::size_t __n)
+      {
+	for (std::size_t __i = 1; __i < __n; ++__i)
+	  {
+	    _Tp __x = std::move(__first[__i]);
+	    std::size_t __j = __i;
+	    for (; __j > 0 and __x < __first[__j - 1]; --__j)
+	      __first[__j] = std::move(__first[__j - 1]);
+	    __first[__j] = std::move(__x);
+	  }
+      }
+  }
+
+  // Sorts the first __n elements of the contiguous range __r in ascending order. If __n is a
+  // constexpr_value, a sorting network of branchless compare-exchanges is used (up to 32
+  // elements); otherwise (and for larger constants) insertion sort for small and std::sort for
+  // large sizes:
+  //   float window[9] = ...;
+  //   vir::sort(window, std::cw<9>);  // 25 compare-exchanges
+  template <std::ranges::contiguous_range _Rg, typename _Np>
+    requires std::convertible_to<_Np, std::size_t>
+	       and std::ranges::output_range<_Rg, std::ranges::range_value_t<_Rg>>
+    constexpr void
+    sort(_Rg&& __r, _Np __n)
+    {
+      auto* __p = std::ranges::data(__r);
+      if constexpr (__detail::__use_sorting_network<_Np>())
+	{
+	  // sizes 0 and 1 are sorted (and have no network)
+	  if constexpr (_Np::value > 1)
+	    {
+	      constexpr auto& __net = __detail::__network<_Np::value>;
+	      [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+		(__detail::__compare_exchange(__p[__net._M_cmp[_Is]._M_i],
+					      __p[__net._M_cmp[_Is]._M_j]), ...);
+	      }(std::make_index_sequence<__net._M_size>());
+	    }
+	}
+      else if (__n <= __detail::__insertion_sort_max)
+	__detail::__insertion_sort(__p, __n);
+      else
+	std::sort(__p, __p + std::size_t(__n));
+    }
+
+  // Sorts the constants at compile time. The result is a constexpr_wrapper of a std::array of the
+  // common type, in ascending order:
+  //   vir::sort(std::cw<3>, std::cw<1>, std::cw<2>)  ->  cw<std::array{1, 2, 3}>
+  template <std::constexpr_value... _Cs>
+    requires (sizeof...(_Cs) > 0)
+    constexpr auto
+    sort(_Cs...)
+    {
+      using _Tp = std::common_type_t<typename _Cs::value_type...>;
+      return std::cw<__detail::__insertion_sorted(std::array<_Tp, sizeof...(_Cs)>{
+		       static_cast<_Tp>(_Cs::value)...})>;
+    }
+
+  // Index of the first element of the sorted constant table that is not less than the constant
+  // key (i.e. of the key itself if it is in the table), as a constant.
+  template <std::constexpr_value _Key, std::constexpr_value _Table>
+    requires (__detail::__is_sorted(_Table::value))
+    constexpr auto
+    sorted_index_of(_Key, _Table)
+    { return std::cw<__detail::__lower_bound_index(_Table::value, _Key::value)>; }
+
+  // Runtime lower_bound over a sorted constant table, returning the index into the table (its
+  // size if all elements are less than __key). The search uses a copy of the table in Eytzinger
+  // order that is built at compile time, and a branchless descent:
+  //   constexpr auto routes = vir::sort(std::cw<40>, std::cw<10>, std::cw<30>, std::cw<20>);
+  //   std::size_t i = vir::lower_bound(routes, port);
+  template <std::constexpr_value _Table, typename _Key>
+    requires (__detail::__is_sorted(_Table::value))
+    constexpr std::size_t
+    lower_bound(_Table, const _Key& __key)
+    {
+      constexpr auto& __e = __detail::__eytzinger<_Table>;
+      constexpr std::size_t __n = std::size(_Table::value);
+      std::size_t __k = 1;
+      while (__k <= __n)
+	{
+	  if constexpr (sizeof(__e._M_elems) >= __detail::__eytzinger_prefetch_min)
+	    if (not std::is_constant_evaluated())
+	      __builtin_prefetch(__e._M_elems.data() + (16 * __k < __n ? 16 * __k : 0));
+	  __k = 2 * __k + (__e._M_elems[__k] < __key);
+	}
+      // The path went right (bit 1) after the lower bound and left (bit 0) at the lower bound:
+      // drop the trailing ones and the zero.
+      __k >>= std::countr_one(__k) + 1;
+      return __e._M_index[__k];
+    }
+}
+
+#endif  // VIR_CW_SORT_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,286 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_STENCIL_HPP_
+#define VIR_CW_STENCIL_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <utility>
+
+namespace vir
+{
+  namespace __detail
+  {
+    // Kernels are (nested) std::arrays of odd extents, centered on the middle element.
+    template <typename _Tp>
+      struct __stencil_shape
+      { static constexpr int _S_rank = 0; };
+
+    template <typename _Tp, std::size_t _Np>
+      requires (_Np % 2 == 1)
+      struct __stencil_shape<std::array<_Tp, _Np>>
+      {
+	static constexpr int _S_rank = 1;
+	static constexpr std::size_t _S_rows = 1;
+	static constexpr std::size_t _S_cols = _Np;
+	using _Coef = _Tp;
+
+	static constexpr _Tp
+	_S_at(const std::array<_Tp, _Np>& __k, std::size_t, std::size_t __j)
+	{ return __k[__j]; }
+      };
+
+    template <typename _Tp, std::size_t _Hp, std::size_t _Wp>
+      requires (_Hp % 2 == 1 and _Wp % 2 == 1)
+      struct __stencil_shape<std::array<std::array<_Tp, _Wp>, _Hp>>
+      {
+	static constexpr int _S_rank = 2;
+	static constexpr std::size_t _S_rows = _Hp;
+	static constexpr std::size_t _S_cols = _Wp;
+	using _Coef = _Tp;
+
+	static constexpr _Tp
+	_S_at(const std::array<std::array<_Tp, _Wp>, _Hp>& __k, std::size_t __i, std::size_t __j)
+	{ return __k[__i][__j]; }
+      };
+
+    template <typename _Kp, int _Rank>
+      concept __stencil_kernel = std::constexpr_value<_Kp>
+				   and __stencil_shape<typename _Kp::value_type>::_S_rank == _Rank;
+
+    // The taps of a kernel, grouped by absolute coefficient. Every group costs one
+    // multiplication (none for 1, a shift for powers of 2 with integral inputs), every other tap
+    // one addition or subtraction. Symmetric kernels thus fold to c * (x[-1] + x[1]), antisymmetric
+    // ones to c * (x[1] - x[-1]), and e.g. the 3x3 binomial kernel needs 3 instead of 9
+    // multiplications. Zero taps are dropped.
+    //
+    // Within a group the added taps come first. A group without added taps is subtracted as a
+    // whole (after the added groups).
+    template <typename _Cp, std::size_t _Np>
+      struct __stencil_plan
+      {
+	struct _Tap
+	{
+	  int _M_dy;
+	  int _M_dx;
+	  bool _M_sub;
+	};
+
+	std::size_t _M_groups = 0;
+	std::size_t _M_taps = 0;
+	_Cp _M_coef[_Np] = {};
+	bool _M_sub[_Np] = {};
+	std::size_t _M_begin[_Np + 1] = {};
+	_Tap _M_tap[_Np] = {};
+      };
+
+    template <typename _Kernel>
+      consteval auto
+      __make_stencil_plan(const _Kernel& __k)
+      {
+	using _Shape = __stencil_shape<_Kernel>;
+	using _Cp = typename _Shape::_Coef;
+	constexpr std::size_t __rows = _Shape::_S_rows;
+	constexpr std::size_t __cols = _Shape::_S_cols;
+	constexpr std::size_t __n = __rows * __cols;
+	auto __abs = [](_Cp __c) { return __c < _Cp() ? _Cp(-__c) : __c; };
+
+	// distinct absolute coefficients, in order of first appearance
+	_Cp __coef[__n] = {};
+	std::size_t __ncoef = 0;
+	for (std::size_t __i = 0; __i < __rows; ++__i)
+	  for (std::size_t __j = 0; __j < __cols; ++__j)
+	    {
+	      const _Cp __c = __abs(_Shape::_S_at(__k, __i, __j));
+	      if (__c == _Cp())
+		continue;
+	      bool __seen = false;
+	      for (std::size_t __g = 0; __g < __ncoef; ++__g)
+		__seen = __seen or __coef[__g] == __c;
+	      if (not __seen)
+		__coef[__ncoef++] = __c;
+	    }
+
+	__stencil_plan<_Cp, __n> __p = {};
+	auto __has_added = [&](_Cp __c) {
+	  for (std::size_t __i = 0; __i < __rows; ++__i)
+	    for (std::size_t __j = 0; __j < __cols; ++__j)
+	      if (_Shape::_S_at(__k, __i, __j) == __c)
+		return true;
+	  return false;
+	};
+	// pass 0: groups with added taps, pass 1: subtracted groups
+	for (int __pass = 0; __pass < 2; ++__pass)
+	  for (std::size_t __g = 0; __g < __ncoef; ++__g)
+	    {
+	      const _Cp __c = __coef[__g];
+	      const bool __sub = not __has_added(__c);
+	      if (__sub != (__pass == 1))
+		continue;
+	      __p._M_coef[__p._M_groups] = __c;
+	      __p._M_sub[__p._M_groups] = __sub;
+	      // added taps first, relative to the sign of the group
+	      for (int __tpass = 0; __tpass < 2; ++__tpass)
+		for (std::size_t __i = 0; __i < __rows; ++__i)
+		  for (std::size_t __j = 0; __j < __cols; ++__j)
+		    {
+		      const _Cp __v = _Shape::_S_at(__k, __i, __j);
+		      if (__abs(__v) != __c)
+			continue;
+		      const bool __tsub = (__v != __c) != __sub;
+		      if (__tsub != (__tpass == 1))
+			continue;
+		      __p._M_tap[__p._M_taps++] = {int(__i) - int(__rows / 2),
+						   int(__j) - int(__cols / 2), __tsub};
+		    }
+	      __p._M_begin[++__p._M_groups] = __p._M_taps;
+	    }
+	return __p;
+      }
+
+    template <typename _Kp>
+      inline constexpr auto __stencil_plan_for = __make_stencil_plan(_Kp::value);
+
+    // c * __s, where c is the constant coefficient: nothing for 1, a shift for powers of 2 and
+    // integral __s (via the operators of constexpr_wrapper)
+    template <auto _Cv, typename _Acc>
+      [[gnu::always_inline]] constexpr _Acc
+      __stencil_scale(const _Acc& __s)
+      {
+	if constexpr (_Cv == 1)
+	  return __s;
+	else
+	  return _Acc(__s * std::cw<_Cv>);
+      }
+
+    // Σ c[i][j] * __at(cw<i - r0>, cw<j - r1>) according to the plan of _Kp
+    template <typename _Kp, typename _Acc, typename _Fp>
+      [[gnu::always_inline]] constexpr _Acc
+      __stencil_eval(_Fp& __at)
+      {
+	constexpr auto& __p = __stencil_plan_for<_Kp>;
+	auto __load = [&]<std::size_t _Tap>() __attribute__((__always_inline__)) -> _Acc {
+	  constexpr auto __t = __p._M_tap[_Tap];
+	  if constexpr (__stencil_shape<typename _Kp::value_type>::_S_rank == 1)
+	    return _Acc(__at(std::cw<__t._M_dx>));
+	  else
+	    return _Acc(__at(std::cw<__t._M_dy>, std::cw<__t._M_dx>));
+	};
+	auto __group = [&]<std::size_t _Gp>() __attribute__((__always_inline__)) {
+	  constexpr std::size_t __b = __p._M_begin[_Gp];
+	  return [&]<std::size_t... _Is>(std::index_sequence<_Is...>)
+		   __attribute__((__always_inline__)) {
+	    _Acc __s = __load.template operator()<__b>();
+	    ((__s = __p._M_tap[__b + 1 + _Is]._M_sub
+		      ? _Acc(__s - __load.template operator()<__b + 1 + _Is>())
+		      : _Acc(__s + __load.template operator()<__b + 1 + _Is>())), ...);
+	    return __stencil_scale<__p._M_coef[_Gp]>(__s);
+	  }(std::make_index_sequence<__p._M_begin[_Gp + 1] - __b - 1>());
+	};
+	if constexpr (__p._M_groups == 0)
+	  return _Acc();
+	else
+	  return [&]<std::size_t... _Gs>(std::index_sequence<_Gs...>)
+		   __attribute__((__always_inline__)) {
+	    _Acc __r = __p._M_sub[0] ? _Acc(-__group.template operator()<0>())
+				     : __group.template operator()<0>();
+	    ((__r = __p._M_sub[_Gs + 1] ? _Acc(__r - __group.template operator()<_Gs + 1>())
+					: _Acc(__r + __group.template operator()<_Gs + 1>())), ...);
+	    return __r;
+	  }(std::make_index_sequence<__p._M_groups - 1>());
+      }
+
+    // the result type of __at
+    template <int _Rank, typename _Fp>
+      struct __stencil_input
+      { using type = std::invoke_result_t<_Fp&, std::constexpr_wrapper<0>>; };
+
+    template <typename _Fp>
+      struct __stencil_input<2, _Fp>
+      {
+	using type
+	  = std::invoke_result_t<_Fp&, std::constexpr_wrapper<0>, std::constexpr_wrapper<0>>;
+      };
+
+    template <typename _Tp, typename _Kp>
+      using __stencil_acc_t = decltype(std::declval<_Tp>()
+					 * std::declval<typename __stencil_shape<
+						typename _Kp::value_type>::_Coef>());
+  }
+
+  // Applies the constant kernel at one point: Σ k[i][j] * __at(cw<i - r0>, cw<j - r1>) for a 2D
+  // kernel k of extents (2 r0 + 1) x (2 r1 + 1), or Σ k[j] * __at(cw<j - r>) for a 1D kernel.
+  // Zero taps are skipped and equal coefficients are factored out (see __stencil_plan). The
+  // result type is the type of the product of an input (the result of __at) and a coefficient,
+  // e.g. int for unsigned char pixels and an int kernel.
+  //   constexpr std::array<std::array<int, 3>, 3> sobel_x = {{{-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1}}};
+  //   int gx = vir::stencil_at(std::cw<sobel_x>, [&](auto dy, auto dx) {
+  //              return img[(y + dy) * w + x + dx];
+  //            });
+  //   // (img[..+1] + img[..+1] - img[..-1] - img[..-1]) + ((img[..+1] - img[..-1]) << 1)
+  template <std::constexpr_value _Kp, typename _Fp>
+    requires (__detail::__stencil_shape<typename _Kp::value_type>::_S_rank != 0)
+    constexpr auto
+    stencil_at(_Kp, _Fp&& __at)
+    {
+      using _In = typename __detail::__stencil_input<
+		    __detail::__stencil_shape<typename _Kp::value_type>::_S_rank, _Fp>::type;
+      return __detail::__stencil_eval<_Kp, __detail::__stencil_acc_t<_In, _Kp>>(__at);
+    }
+
+  // 1D stencil over a contiguous range: out[i] = __post(Σ k[j] * in[i + j - r]) for i in
+  // [r, size(in) - r). The first and last r elements of __out are not written. __post converts
+  // the accumulated value to the output, e.g. `[](int s) { return s / std::cw<16>; }` to
+  // normalize an integer binomial kernel (a shift, see constexpr_wrapper's operator/).
+  template <std::ranges::contiguous_range _In, std::ranges::contiguous_range _Out,
+	    __detail::__stencil_kernel<1> _Kp, typename _Post = std::identity>
+    constexpr void
+    stencil(const _In& __in, _Out&& __out, _Kp __k, _Post __post = {})
+    {
+      using _OutT = std::ranges::range_value_t<_Out>;
+      constexpr std::size_t __r = __detail::__stencil_shape<typename _Kp::value_type>::_S_cols / 2;
+      const auto* __src = std::ranges::data(__in);
+      auto* __dst = std::ranges::data(__out);
+      const std::size_t __n = std::ranges::size(__in);
+      for (std::size_t __i = __r; __i + __r < __n; ++__i)
+	__dst[__i] = static_cast<_OutT>(__post(vir::stencil_at(__k, [&](auto __dx) {
+				  return __src[__i + decltype(__dx)::value];
+				})));
+    }
+
+  // 2D stencil over a row-major image of the given width (the row stride of both __in and
+  // __out): out[y][x] = __post(Σ k[i][j] * in[y + i - r0][x + j - r1]) for all points that are at
+  // least (r0, r1) away from the border. The border of __out is not written.
+  template <std::ranges::contiguous_range _In, std::ranges::contiguous_range _Out,
+	    typename _Wp, __detail::__stencil_kernel<2> _Kp, typename _Post = std::identity>
+    requires std::convertible_to<_Wp, std::size_t>
+    constexpr void
+    stencil(const _In& __in, _Out&& __out, _Wp __width, _Kp __k, _Post __post = {})
+    {
+      using _OutT = std::ranges::range_value_t<_Out>;
+      using _Shape = __detail::__stencil_shape<typename _Kp::value_type>;
+      constexpr std::size_t __r0 = _Shape::_S_rows / 2;
+      constexpr std::size_t __r1 = _Shape::_S_cols / 2;
+      const auto* __src = std::ranges::data(__in);
+      auto* __dst = std::ranges::data(__out);
+      const std::size_t __w = __width;
+      const std::size_t __h = std::ranges::size(__in) / __w;
+      for (std::size_t __y = __r0; __y + __r0 < __h; ++__y)
+	for (std::size_t __x = __r1; __x + __r1 < __w; ++__x)
+	  __dst[__y * __w + __x] = static_cast<_OutT>(__post(vir::stencil_at(__k,
+				     [&](auto __dy, auto __dx) {
+				       return __src[(__y + decltype(__dy)::value) * __w
+						      + __x + decltype(__dx)::value];
+				     })));
+    }
+}
+
+#endif  // VIR_CW_STENCIL_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
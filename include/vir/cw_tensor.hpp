@@ -0,0 +1,262 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_TENSOR_HPP_
+#define VIR_CW_TENSOR_HPP_
+
+#include <constexpr_wrapper.hpp>
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace vir
+{
+  // Strides of a tensor_view that are implied by the extents: row-major, without padding (like
+  // std::layout_right).
+  struct layout_right
+  {};
+
+  namespace __detail
+  {
+    // An extent, stride, or index: a runtime integer or a constexpr_value, normalized to
+    // std::size_t or std::constexpr_wrapper<std::size_t(N)>.
+    template <typename _Tp>
+      concept __tensor_index = std::integral<_Tp> or std::constexpr_value<_Tp, std::size_t>;
+
+    template <__tensor_index _Tp>
+      constexpr auto
+      __tensor_size(_Tp __n)
+      {
+	if constexpr (std::constexpr_value<_Tp>)
+	  return std::cw<std::size_t(_Tp::value)>;
+	else
+	  return std::size_t(__n);
+      }
+
+    template <typename _Tp>
+      using __tensor_size_t = decltype(__tensor_size(std::declval<_Tp>()));
+
+    template <typename _Tp>
+      concept __constant_one = std::constexpr_value<_Tp> and _Tp::value == 1;
+
+    // The number of runtime values among the first _Np elements of the tuple type _Tuple.
+    template <typename _Tuple, std::size_t _Np = std::tuple_size_v<_Tuple>>
+      inline constexpr std::size_t __tensor_runtime_count
+	= []<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	    return (0uz + ... + !std::constexpr_value<std::tuple_element_t<_Is, _Tuple>>);
+	  }(std::make_index_sequence<_Np>());
+
+    template <typename _Strides>
+      using __tensor_strides_tuple
+	= std::conditional_t<std::same_as<_Strides, layout_right>, std::tuple<>, _Strides>;
+  }
+
+  template <typename _Tp, typename _Extents, typename _Strides = layout_right>
+    struct tensor_view;
+
+  // A non-owning view of a rank-N array, where every extent and stride is either a std::size_t or
+  // a std::constexpr_wrapper<std::size_t(N)>. Offsets are computed with the constexpr_wrapper
+  // operators, so that constant strides are folded into the address computation (e.g. a shift
+  // for a power of 2) and an all-constant index into a constant offset. Only the runtime extents
+  // and strides are stored (the constants are part of the type), so a view with only constant
+  // extents and strides has the size of a pointer:
+  //   // NCHW with runtime N, H, W and 3 channels
+  //   auto img = vir::make_tensor_view(data, n, std::cw<3>, h, w);
+  //   img(b, std::cw<1>, y, x) = ...;
+  template <typename _Tp, typename... _Es, typename _Strides>
+    struct tensor_view<_Tp, std::tuple<_Es...>, _Strides>
+    {
+      using element_type = _Tp;
+
+      using extents_type = std::tuple<_Es...>;
+
+      using strides_type = _Strides;
+
+      // The runtime extents, followed by the runtime strides.
+      static constexpr std::size_t _S_runtime_count
+	= __detail::__tensor_runtime_count<extents_type>
+	    + __detail::__tensor_runtime_count<__detail::__tensor_strides_tuple<_Strides>>;
+
+      _Tp* _M_data;
+
+      // Not a std::array<std::size_t, 0>, which is not empty.
+      [[no_unique_address]]
+	std::conditional_t<_S_runtime_count == 0, std::tuple<>,
+			   std::array<std::size_t, _S_runtime_count>> _M_runtime;
+
+      static constexpr std::constexpr_wrapper<sizeof...(_Es)> rank{};
+
+      // Whether all elements are contiguous in row-major order, i.e. the view can be traversed as
+      // a flat array of size() elements. Only layout_right is known to be contiguous.
+      static constexpr std::constexpr_wrapper<std::same_as<_Strides, layout_right>> is_contiguous{};
+
+      // Whether the last dimension has a constant stride of 1, i.e. the innermost loop of a
+      // traversal is over contiguous elements (and thus vectorizable).
+      static constexpr std::constexpr_wrapper<[] {
+	if constexpr (std::same_as<_Strides, layout_right> or sizeof...(_Es) == 0)
+	  return true;
+	else
+	  return __detail::__constant_one<std::tuple_element_t<sizeof...(_Es) - 1, _Strides>>;
+      }()> is_contiguous_inner{};
+
+      constexpr _Tp*
+      data() const
+      { return _M_data; }
+
+      template <std::constexpr_value<std::size_t> _Kp>
+	requires (_Kp::value < sizeof...(_Es))
+	constexpr auto
+	extent(_Kp) const
+	{
+	  using _Ep = std::tuple_element_t<_Kp::value, extents_type>;
+	  if constexpr (std::constexpr_value<_Ep>)
+	    return _Ep();
+	  else
+	    return _M_runtime[__detail::__tensor_runtime_count<extents_type, _Kp::value>];
+	}
+
+      template <std::constexpr_value<std::size_t> _Kp>
+	requires (_Kp::value < sizeof...(_Es))
+	constexpr auto
+	stride(_Kp) const
+	{
+	  if constexpr (std::same_as<_Strides, layout_right>)
+	    return [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	      return (std::cw<1uz> * ... * extent(std::cw<_Kp::value + 1 + _Is>));
+	    }(std::make_index_sequence<sizeof...(_Es) - 1 - _Kp::value>());
+	  else if constexpr (std::constexpr_value<std::tuple_element_t<_Kp::value, _Strides>>)
+	    return std::tuple_element_t<_Kp::value, _Strides>();
+	  else
+	    return _M_runtime[__detail::__tensor_runtime_count<extents_type>
+				+ __detail::__tensor_runtime_count<_Strides, _Kp::value>];
+	}
+
+      // The number of elements, as a constant if all extents are constants.
+      constexpr auto
+      size() const
+      {
+	return [&]<std::size_t... _Is>(std::index_sequence<_Is...>) {
+	  return (std::cw<1uz> * ... * extent(std::cw<_Is>));
+	}(std::index_sequence_for<_Es...>());
+      }
+
+      // The offset of the element at the given indices, as a constant if all indices and strides
+      // are constants.
+      template <__detail::__tensor_index... _Is>
+	requires (sizeof...(_Is) == sizeof...(_Es))
+	constexpr auto
+	offset(_Is... __idx) const
+	{
+	  return [&]<std::size_t... _Ks>(std::index_sequence<_Ks...>) {
+	    return (std::cw<0uz> + ... + (__detail::__tensor_size(__idx) * stride(std::cw<_Ks>)));
+	  }(std::index_sequence_for<_Es...>());
+	}
+
+      template <__detail::__tensor_index... _Is>
+	requires (sizeof...(_Is) == sizeof...(_Es))
+	constexpr _Tp&
+	operator()(_Is... __idx) const
+	{ return _M_data[std::size_t(offset(__idx...))]; }
+
+#if __cpp_multidimensional_subscript
+      template <__detail::__tensor_index... _Is>
+	requires (sizeof...(_Is) == sizeof...(_Es))
+	constexpr _Tp&
+	operator[](_Is... __idx) const
+	{ return _M_data[std::size_t(offset(__idx...))]; }
+#endif
+    };
+
+  namespace __detail
+  {
+    // A view of __p, initialized from all of its extents and then all of its strides (already
+    // normalized by __tensor_size), of which only the runtime values are stored.
+    template <typename _View, typename... _Vs>
+      constexpr _View
+      __tensor_make(typename _View::element_type* __p, _Vs... __values)
+      {
+	_View __r{__p, {}};
+	[[maybe_unused]] std::size_t __i = 0;
+	([&] {
+	  if constexpr (not std::constexpr_value<_Vs>)
+	    __r._M_runtime[__i++] = __values;
+	}(), ...);
+	return __r;
+      }
+  }
+
+  // A row-major view of __p with the given extents (integers or constexpr_values).
+  template <typename _Tp, __detail::__tensor_index... _Ns>
+    constexpr tensor_view<_Tp, std::tuple<__detail::__tensor_size_t<_Ns>...>>
+    make_tensor_view(_Tp* __p, _Ns... __extents)
+    {
+      using _View = tensor_view<_Tp, std::tuple<__detail::__tensor_size_t<_Ns>...>>;
+      return __detail::__tensor_make<_View>(__p, __detail::__tensor_size(__extents)...);
+    }
+
+  // A view of __p with explicit strides (in elements), e.g. for a transposed or padded array:
+  //   auto t = vir::make_strided_view(data, std::tuple(std::cw<4>, n), std::tuple(std::cw<1>, ld));
+  template <typename _Tp, __detail::__tensor_index... _Ns, __detail::__tensor_index... _Ss>
+    requires (sizeof...(_Ns) == sizeof...(_Ss))
+    constexpr tensor_view<_Tp, std::tuple<__detail::__tensor_size_t<_Ns>...>,
+			  std::tuple<__detail::__tensor_size_t<_Ss>...>>
+    make_strided_view(_Tp* __p, std::tuple<_Ns...> __extents, std::tuple<_Ss...> __strides)
+    {
+      using _View = tensor_view<_Tp, std::tuple<__detail::__tensor_size_t<_Ns>...>,
+				std::tuple<__detail::__tensor_size_t<_Ss>...>>;
+      return [&]<std::size_t... _Ks>(std::index_sequence<_Ks...>) {
+	return __detail::__tensor_make<_View>(
+		 __p, __detail::__tensor_size(std::get<_Ks>(__extents))...,
+		 __detail::__tensor_size(std::get<_Ks>(__strides))...);
+      }(std::index_sequence_for<_Ns...>());
+    }
+
+  namespace __detail
+  {
+    template <std::size_t _Kp, typename _View, typename _Fp>
+      constexpr void
+      __tensor_loop(const _View& __v, typename _View::element_type* __p, _Fp& __f)
+      {
+	const auto __n = __v.extent(std::cw<_Kp>);
+	const auto __s = __v.stride(std::cw<_Kp>);
+	if constexpr (_Kp + 1 == _View::rank)
+	  {
+	    // with a constant stride of 1 this is a plain contiguous loop
+	    for (std::size_t __i = 0; __i < __n; ++__i)
+	      __f(__p[std::size_t(__i * __s)]);
+	  }
+	else
+	  for (std::size_t __i = 0; __i < __n; ++__i)
+	    __tensor_loop<_Kp + 1>(__v, __p + std::size_t(__i * __s), __f);
+      }
+  }
+
+  // Calls __f(element) for every element, in row-major order. A contiguous view is traversed as
+  // one flat loop; otherwise the loops are nested, with the innermost loop over the last
+  // dimension (contiguous if is_contiguous_inner). Constant extents give constant trip counts.
+  template <typename _Tp, typename _Extents, typename _Strides, typename _Fp>
+    constexpr void
+    for_each(const tensor_view<_Tp, _Extents, _Strides>& __v, _Fp&& __f)
+    {
+      using _View = tensor_view<_Tp, _Extents, _Strides>;
+      if constexpr (_View::rank == 0)
+	__f(*__v.data());
+      else if constexpr (_View::is_contiguous)
+	{
+	  const auto __n = __v.size();
+	  for (std::size_t __i = 0; __i < __n; ++__i)
+	    __f(__v.data()[__i]);
+	}
+      else
+	__detail::__tensor_loop<0>(__v, __v.data(), __f);
+    }
+}
+
+#endif  // VIR_CW_TENSOR_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
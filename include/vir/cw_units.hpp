@@ -0,0 +1,334 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_UNITS_HPP_
+#define VIR_CW_UNITS_HPP_
+
+#include <constexpr_wrapper.hpp>
+#include <vir/cw_ratio.hpp>
+
+#include <compare>
+
+namespace vir::units
+{
+  // Exponents of the SI base dimensions. Structural, so that it can be used as a template argument.
+  struct dimension
+  {
+    int length = 0;
+    int mass = 0;
+    int time = 0;
+    int current = 0;
+    int temperature = 0;
+    int amount = 0;
+    int luminosity = 0;
+
+    friend constexpr bool
+    operator==(const dimension&, const dimension&) = default;
+
+    friend constexpr dimension
+    operator*(dimension __a, dimension __b)
+    {
+      return {__a.length + __b.length, __a.mass + __b.mass, __a.time + __b.time,
+	      __a.current + __b.current, __a.temperature + __b.temperature,
+	      __a.amount + __b.amount, __a.luminosity + __b.luminosity};
+    }
+
+    friend constexpr dimension
+    operator/(dimension __a, dimension __b)
+    {
+      return {__a.length - __b.length, __a.mass - __b.mass, __a.time - __b.time,
+	      __a.current - __b.current, __a.temperature - __b.temperature,
+	      __a.amount - __b.amount, __a.luminosity - __b.luminosity};
+    }
+  };
+
+  namespace dimensions
+  {
+    inline constexpr dimension none = {};
+    inline constexpr dimension length = {.length = 1};
+    inline constexpr dimension mass = {.mass = 1};
+    inline constexpr dimension time = {.time = 1};
+    inline constexpr dimension current = {.current = 1};
+    inline constexpr dimension temperature = {.temperature = 1};
+    inline constexpr dimension amount = {.amount = 1};
+    inline constexpr dimension luminosity = {.luminosity = 1};
+  }
+
+  namespace __detail
+  {
+    // Integral and ratio scales are exact: conversions between them never round the factor.
+    template <typename _Tp>
+      concept __exact_scale = std::integral<typename _Tp::value_type>
+				or std::same_as<typename _Tp::value_type, ratio>;
+
+    template <std::constexpr_value _Ap, std::constexpr_value _Bp>
+      consteval auto
+      __scale_product()
+      {
+	if constexpr (std::integral<typename _Ap::value_type>
+			and std::integral<typename _Bp::value_type>)
+	  return _Ap() * _Bp();
+	else if constexpr (__exact_scale<_Ap> and __exact_scale<_Bp>)
+	  return std::cw<ratio(_Ap::value) * ratio(_Bp::value)>;
+	else
+	  return std::cw<double(_Ap::value) * double(_Bp::value)>;
+      }
+
+    // The scale of a quotient of units. Exact scales that don't divide evenly become a ratio.
+    template <std::constexpr_value _Ap, std::constexpr_value _Bp>
+      consteval auto
+      __scale_quotient()
+      {
+	if constexpr (__exact_scale<_Ap> and __exact_scale<_Bp>)
+	  {
+	    constexpr ratio __q = ratio(_Ap::value) / ratio(_Bp::value);
+	    if constexpr (std::integral<typename _Ap::value_type>
+			    and std::integral<typename _Bp::value_type> and __q.den == 1)
+	      return _Ap() / _Bp();
+	    else
+	      return std::cw<__q>;
+	  }
+	else
+	  return std::cw<double(_Ap::value) / double(_Bp::value)>;
+      }
+
+    // Converts __x from a unit with scale _From to a unit with scale _To. The conversion factor
+    // is computed at compile time, so that the conversion is either a no-op, a single multiply,
+    // or (integral value types) an exact integer multiply and/or divide.
+    template <std::constexpr_value _From, std::constexpr_value _To, typename _Tp>
+      constexpr _Tp
+      __rescale(_Tp __x)
+      {
+	if constexpr (__exact_scale<_From> and __exact_scale<_To>)
+	  {
+	    constexpr ratio __q = ratio(_From::value) / ratio(_To::value);
+	    if constexpr (__q == ratio(1))
+	      return __x;
+	    else if constexpr (std::floating_point<_Tp>)
+	      {
+		constexpr _Tp __factor = _Tp(__q);
+		return __x * __factor;
+	      }
+	    else if constexpr (__q.den == 1)
+	      return __x * static_cast<_Tp>(__q.num);
+	    else if constexpr (__q.num == 1)
+	      return __x / static_cast<_Tp>(__q.den);
+	    else
+	      return __x * static_cast<_Tp>(__q.num) / static_cast<_Tp>(__q.den);
+	  }
+	else
+	  {
+	    constexpr double __factor = double(_From::value) / double(_To::value);
+	    if constexpr (__factor == 1)
+	      return __x;
+	    else if constexpr (std::floating_point<_Tp>)
+	      {
+		constexpr _Tp __factor_t = _Tp(__factor);
+		return __x * __factor_t;
+	      }
+	    else
+	      return static_cast<_Tp>(__x * __factor);
+	  }
+      }
+
+    // Whether the conversion can be implicit: floating-point values, or exact integral factors.
+    template <std::constexpr_value _From, std::constexpr_value _To, typename _Tp>
+      consteval bool
+      __lossless_rescale()
+      {
+	if constexpr (std::floating_point<_Tp>)
+	  return true;
+	else if constexpr (__exact_scale<_From> and __exact_scale<_To>)
+	  return (ratio(_From::value) / ratio(_To::value)).den == 1;
+	else
+	  return double(_From::value) == double(_To::value);
+      }
+  }
+
+  // A unit is a dimension and a scale relative to the coherent SI unit of that dimension. The
+  // scale is a constexpr_value: an integer (e.g. `std::cw<1000>` for kilo), a vir::ratio (e.g.
+  // `std::cw<vir::ratio(1, 1000)>` for milli), or a floating-point value. Units multiply and divide
+  // their scales at compile time.
+  template <dimension _Dim, std::constexpr_value _Scale = std::constexpr_wrapper<1>>
+    struct unit
+    {
+      static constexpr dimension dim = _Dim;
+
+      using scale = _Scale;
+
+      template <dimension _Dim2, typename _Scale2>
+	friend constexpr
+	unit<_Dim * _Dim2, decltype(__detail::__scale_product<_Scale, _Scale2>())>
+	operator*(unit, unit<_Dim2, _Scale2>)
+	{ return {}; }
+
+      template <dimension _Dim2, typename _Scale2>
+	friend constexpr
+	unit<_Dim / _Dim2, decltype(__detail::__scale_quotient<_Scale, _Scale2>())>
+	operator/(unit, unit<_Dim2, _Scale2>)
+	{ return {}; }
+    };
+
+  template <typename _Tp>
+    concept any_unit = requires {
+      { _Tp::dim } -> std::convertible_to<dimension>;
+      typename _Tp::scale;
+    } and std::same_as<_Tp, unit<_Tp::dim, typename _Tp::scale>>;
+
+  template <any_unit _Unit, typename _Tp = double>
+    class quantity;
+
+  template <any_unit _To, typename _Tp = void, typename _From, typename _Up>
+    requires (_To::dim == _From::dim)
+    constexpr auto
+    quantity_cast(const quantity<_From, _Up>& __q)
+    {
+      using _Rp = std::conditional_t<std::is_void_v<_Tp>, _Up, _Tp>;
+      return quantity<_To, _Rp>(
+	       __detail::__rescale<typename _From::scale, typename _To::scale>(
+		 static_cast<_Rp>(__q.count())));
+    }
+
+  template <any_unit _Unit, typename _Tp>
+    class quantity
+    {
+      _Tp _M_value;
+
+    public:
+      using unit_type = _Unit;
+
+      using value_type = _Tp;
+
+      quantity() = default;
+
+      constexpr explicit
+      quantity(_Tp __x)
+      : _M_value(__x)
+      {}
+
+      // Conversion from a quantity of the same dimension. Implicit if lossless.
+      template <typename _Unit2, typename _Up>
+	requires (_Unit2::dim == _Unit::dim and std::convertible_to<_Up, _Tp>)
+	constexpr
+	explicit(not __detail::__lossless_rescale<typename _Unit2::scale,
+						  typename _Unit::scale, _Tp>())
+	quantity(const quantity<_Unit2, _Up>& __q)
+	: _M_value(quantity_cast<_Unit, _Tp>(__q).count())
+	{}
+
+      constexpr _Tp
+      count() const
+      { return _M_value; }
+
+      constexpr quantity
+      operator-() const
+      { return quantity(-_M_value); }
+
+      constexpr quantity&
+      operator+=(const quantity& __b)
+      {
+	_M_value += __b._M_value;
+	return *this;
+      }
+
+      constexpr quantity&
+      operator-=(const quantity& __b)
+      {
+	_M_value -= __b._M_value;
+	return *this;
+      }
+
+      friend constexpr quantity
+      operator+(quantity __a, const quantity& __b)
+      { return __a += __b; }
+
+      friend constexpr quantity
+      operator-(quantity __a, const quantity& __b)
+      { return __a -= __b; }
+
+      friend constexpr bool
+      operator==(const quantity&, const quantity&) = default;
+
+      friend constexpr auto
+      operator<=>(const quantity&, const quantity&) = default;
+
+      friend constexpr quantity
+      operator*(quantity __a, _Tp __s)
+      { return quantity(__a._M_value * __s); }
+
+      friend constexpr quantity
+      operator*(_Tp __s, quantity __a)
+      { return quantity(__s * __a._M_value); }
+
+      friend constexpr quantity
+      operator/(quantity __a, _Tp __s)
+      { return quantity(__a._M_value / __s); }
+
+      // Products and quotients don't convert anything; the scales are combined at compile time.
+      template <typename _Unit2, typename _Up>
+	friend constexpr auto
+	operator*(const quantity& __a, const quantity<_Unit2, _Up>& __b)
+	{
+	  using _Rp = decltype(__a.count() * __b.count());
+	  return quantity<decltype(_Unit() * _Unit2()), _Rp>(__a.count() * __b.count());
+	}
+
+      template <typename _Unit2, typename _Up>
+	friend constexpr auto
+	operator/(const quantity& __a, const quantity<_Unit2, _Up>& __b)
+	{
+	  using _Rp = decltype(__a.count() / __b.count());
+	  return quantity<decltype(_Unit() / _Unit2()), _Rp>(__a.count() / __b.count());
+	}
+    };
+
+  // `2.5 * kilometre` creates a quantity<kilometre_t, double>.
+  template <typename _Tp, dimension _Dim, typename _Scale>
+    requires std::is_arithmetic_v<_Tp>
+    constexpr quantity<unit<_Dim, _Scale>, _Tp>
+    operator*(_Tp __x, unit<_Dim, _Scale>)
+    { return quantity<unit<_Dim, _Scale>, _Tp>(__x); }
+
+  using one_t = unit<dimensions::none>;
+  using metre_t = unit<dimensions::length>;
+  using kilometre_t = unit<dimensions::length, std::constexpr_wrapper<1000>>;
+  using centimetre_t = unit<dimensions::length, std::constexpr_wrapper<ratio(1, 100)>>;
+  using millimetre_t = unit<dimensions::length, std::constexpr_wrapper<ratio(1, 1000)>>;
+  using kilogram_t = unit<dimensions::mass>;
+  using gram_t = unit<dimensions::mass, std::constexpr_wrapper<ratio(1, 1000)>>;
+  using second_t = unit<dimensions::time>;
+  using millisecond_t = unit<dimensions::time, std::constexpr_wrapper<ratio(1, 1000)>>;
+  using microsecond_t = unit<dimensions::time, std::constexpr_wrapper<ratio(1, 1000000)>>;
+  using minute_t = unit<dimensions::time, std::constexpr_wrapper<60>>;
+  using hour_t = unit<dimensions::time, std::constexpr_wrapper<3600>>;
+  using ampere_t = unit<dimensions::current>;
+  using kelvin_t = unit<dimensions::temperature>;
+  using mole_t = unit<dimensions::amount>;
+  using candela_t = unit<dimensions::luminosity>;
+  using metre_per_second_t = decltype(metre_t() / second_t());
+  using kilometre_per_hour_t = decltype(kilometre_t() / hour_t());
+
+  inline constexpr one_t one;
+  inline constexpr metre_t metre;
+  inline constexpr kilometre_t kilometre;
+  inline constexpr centimetre_t centimetre;
+  inline constexpr millimetre_t millimetre;
+  inline constexpr kilogram_t kilogram;
+  inline constexpr gram_t gram;
+  inline constexpr second_t second;
+  inline constexpr millisecond_t millisecond;
+  inline constexpr microsecond_t microsecond;
+  inline constexpr minute_t minute;
+  inline constexpr hour_t hour;
+  inline constexpr ampere_t ampere;
+  inline constexpr kelvin_t kelvin;
+  inline constexpr mole_t mole;
+  inline constexpr candela_t candela;
+  inline constexpr metre_per_second_t metre_per_second;
+  inline constexpr kilometre_per_hour_t kilometre_per_hour;
+}
+
+#endif  // VIR_CW_UNITS_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* Copyright © 2023 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                  Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef VIR_CW_VARIANT_HPP_
+#define VIR_CW_VARIANT_HPP_
+
+#include <constexpr_wrapper.hpp>
+#include <vir/cw_dispatch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace vir
+{
+  namespace __detail
+  {
+    template <typename _Vp>
+      inline constexpr std::size_t __variant_size = std::variant_size_v<std::remove_cvref_t<_Vp>>;
+
+    // The index of every variant in the flattened index (row-major, the last variant varies
+    // fastest)
+    template <std::size_t _Flat, std::size_t... _Sizes>
+      consteval auto
+      __unflatten()
+      {
+	constexpr std::size_t __n = sizeof...(_Sizes);
+	constexpr std::size_t __sizes[] = {_Sizes...};
+	std::array<std::size_t, __n> __r = {};
+	std::size_t __f = _Flat;
+	for (std::size_t __k = __n; __k > 0; --__k)
+	  {
+	    __r[__k - 1] = __f % __sizes[__k - 1];
+	    __f /= __sizes[__k - 1];
+	  }
+	return __r;
+      }
+  }
+
+  // Calls __f(std::get<I>(__v), std::cw<I>) with I = __v.index(), through a single jump table
+  // (see vir::dispatch). Unlike std::visit, the visitor also gets the alternative index as a
+  // constant, and the results only need a common type:
+  //   vir::visit([&](auto& ev, auto i) { handlers[i](ev); }, event);
+  // Throws std::bad_variant_access if __v is valueless by exception.
+  template <typename _Fp, typename _Vp>
+    requires (__detail::__variant_size<_Vp> > 0)
+    constexpr decltype(auto)
+    visit(_Fp&& __f, _Vp&& __v)
+    {
+      if (__v.valueless_by_exception())
+	throw std::bad_variant_access();
+      return vir::dispatch(__v.index(), std::cw<__detail::__variant_size<_Vp>>,
+			   [&](auto __i) -> decltype(auto) {
+			     constexpr std::size_t __k = decltype(__i)::value;
+			     return std::invoke(__f, std::get<__k>(std::forward<_Vp>(__v)), __i);
+			   });
+    }
+
+  // Multi-visitation: __f(std::get<I0>(__v0), std::get<I1>(__v1), ..., std::cw<I0>, std::cw<I1>,
+  // ...). The index tuple is flattened into a single index into one table of N0 * N1 * ...
+  // entries, i.e. still a single indirect call instead of a nested dispatch per variant.
+  template <typename _Fp, typename _V0, typename _V1, typename... _Vs>
+    requires (__detail::__variant_size<_V0> > 0 and __detail::__variant_size<_V1> > 0
+		and ((__detail::__variant_size<_Vs> > 0) and ...))
+    constexpr decltype(auto)
+    visit(_Fp&& __f, _V0&& __v0, _V1&& __v1, _Vs&&... __vs)
+    {
+      if (__v0.valueless_by_exception() or __v1.valueless_by_exception()
+	    or (__vs.valueless_by_exception() or ...))
+	throw std::bad_variant_access();
+      std::size_t __flat = __v0.index() * __detail::__variant_size<_V1> + __v1.index();
+      ((__flat = __flat * __detail::__variant_size<_Vs> + __vs.index()), ...);
+      constexpr std::size_t __n = (__detail::__variant_size<_V0> * __detail::__variant_size<_V1>)
+				    * (1 * ... * __detail::__variant_size<_Vs>);
+      return vir::dispatch(__flat, std::cw<__n>, [&](auto __i) -> decltype(auto) {
+	       constexpr auto __idx
+		 = __detail::__unflatten<decltype(__i)::value, __detail::__variant_size<_V0>,
+					 __detail::__variant_size<_V1>,
+					 __detail::__variant_size<_Vs>...>();
+	       return [&]<std::size_t... _Ks>(std::index_sequence<_Ks...>) -> decltype(auto) {
+		 return std::invoke(__f, std::get<__idx[0]>(std::forward<_V0>(__v0)),
+				    std::get<__idx[1]>(std::forward<_V1>(__v1)),
+				    std::get<__idx[2 + _Ks]>(std::forward<_Vs>(__vs))...,
+				    std::cw<__idx[0]>, std::cw<__idx[1]>,
+				    std::cw<__idx[2 + _Ks]>...);
+	       }(std::make_index_sequence<sizeof...(_Vs)>());
+	     });
+    }
+}
+
+#endif  // VIR_CW_VARIANT_HPP_
+// vim: noet tw=100 ts=8 sw=2 cc=101
@@ -4,7 +4,28 @@
  */
 
 #include <constexpr_wrapper.hpp>
+#include <vir/cw_memory.hpp>
+#include <vir/cw_linalg.hpp>
+#include <vir/cw_units.hpp>
+#include <vir/cw_ratio.hpp>
+#include <vir/cw_polynomial.hpp>
+#include <vir/cw_math.hpp>
+#include <vir/cw_select.hpp>
+#include <vir/cw_sort.hpp>
+#include <vir/cw_reduce.hpp>
+#include <vir/cw_stencil.hpp>
+#include <vir/cw_bitset.hpp>
+#include <vir/cw_enum.hpp>
+#include <vir/cw_variant.hpp>
+#include <vir/cw_pack.hpp>
+#include <vir/cw_memo.hpp>
+#include <vir/cw_tensor.hpp>
+#include <vir/cw_fixed.hpp>
+#include <vir/cw_crc.hpp>
+#include <algorithm>
 #include <array>
+#include <string> // std::literals must be an inline namespace
+#include <tuple>
 
 #if defined __clang_major__ and __clang_major__ <= 16
   // Clang 16 ICEs saying "error: cannot compile this l-value expression yet"
@@ -18,6 +39,20 @@ static_assert(std::cw<1.f> == 1.f);
 
 static_assert(std::constexpr_value<std::constexpr_wrapper<1>>);
 
+// Distinct constants are distinct empty types without a common base, so they can share an address.
+static_assert(sizeof(std::tuple<std::constexpr_wrapper<1>, std::constexpr_wrapper<2>>) == 1);
+static_assert(sizeof(std::tuple<std::constexpr_wrapper<1>, std::constexpr_wrapper<2>,
+				std::constexpr_wrapper<3>, long>) == sizeof(long));
+
+struct ThreeConstants
+{
+  [[no_unique_address]] std::constexpr_wrapper<1> a;
+  [[no_unique_address]] std::constexpr_wrapper<2> b;
+  [[no_unique_address]] std::constexpr_wrapper<3> c;
+};
+
+static_assert(sizeof(ThreeConstants) == 1);
+
 template <auto _Xp>
   struct Derived
   : std::constexpr_wrapper<_Xp>
@@ -227,13 +262,23 @@ test()
   check<2>(std::cw<NeedsAdl(1)> + std::cw<1>);
   check<2>(std::cw<1> + std::cw<NeedsAdl(1)>);
 
-  // error: 'std::strong_ordering' is not a valid type for a template non-type parameter because it
-  // is not structural
-  //check<std::strong_ordering::less>("fob"_sc <=> "foo"_sc);
+  // std::strong_ordering is not structural; <=> yields a wrapped structural equivalent
+  static_assert(("fob"_sc <=> "foo"_sc) < 0);
+  static_assert(0 > ("fob"_sc <=> "foo"_sc));
+  static_assert(("fob"_sc <=> "foo"_sc) == std::strong_ordering::less);
+  static_assert(("fob"_sc <=> "foo"_sc).value == std::strong_ordering::less);
+  check<true>(("fob"_sc <=> "foo"_sc) < std::cw<0>);
+  check<false>(("foo"_sc <=> "foo"_sc) != std::cw<0>);
+  check<true>((std::cw<2> <=> std::cw<1>) == (std::cw<3> <=> std::cw<0>));
+  constexpr std::strong_ordering ord = (std::cw<2> <=> std::cw<2>).value;
+  static_assert(ord == std::strong_ordering::equal);
 
   check<-1>(std::cw<1> - std::cw<2>);
 #if __cpp_nontype_template_args >= 201911L
   check<4.>(std::cw<2.> * std::cw<2.>);
+  static_assert((std::cw<1.> <=> std::cw<2.>) == std::partial_ordering::less);
+  static_assert((std::cw<0.> <=> std::cw<__builtin_nan("")>) == std::partial_ordering::unordered);
+  check<false>((std::cw<0.> <=> std::cw<__builtin_nan("")>) >= std::cw<0>);
   check<4.f>(std::cw<8.f> / std::cw<2.f>);
 #endif
   check<2u>(std::cw<8u> % std::cw<3u>);
@@ -278,7 +323,7 @@ test()
   check<strlit<char, 7>>("foo"_sc + "bar");
   check<strlit<char, 7>>("foo" + "bar"_sc);
 
-#if __cpp_lib_constexpr_charconv >= 202207L && __cplusplus > 202002L
+#if __cplusplus > 202002L
   using namespace std::literals;
   check<3>(1cw + 2cw);
   check<(signed char)(1)>(1cw);
@@ -295,5 +340,993 @@ test()
   check<0xFFFF>(0xFFFFcw);
   check<0xffff>(0XffffCW);
   check<(signed char)0b1101>(0b1101CW);
+  check<(signed char)0>(0cw);
+  check<(signed char)2>(2cw);
+  check<(signed char)015>(015cw);
+  check<(signed char)0B1010>(0B1010cw);
+  check<0x1'0000>(0x1'0000cw);
+  check<0xabcdef>(0xabcdefcw);
+  check<0xFFFF'FFFF'FFFF'FFFFULL>(0xFFFF'FFFF'FFFF'FFFFCW);
+  check<-128>(-128cw);
+  check<(signed char)-128>(128ncw);
+  check<(signed char)-1>(1ncw);
+  check<(signed char)0>(0ncw);
+  check<short(-129)>(129NCW);
+  check<short(-0x8000)>(0x8000ncw);
+  check<-0x8001>(0x8001ncw);
+  check<-2'147'483'647 - 1>(2'147'483'648ncw);
+  check<-2'147'483'649L>(2'147'483'649ncw);
+  check<-9223372036854775807L - 1>(9223372036854775808ncw);
 #endif
 }
+
+// __cw_copy, __cw_set, and __cw_compare of N bytes at offsets 0 to 3 (unaligned), compared against
+// byte loops; bytes next to the range must not be touched.
+template <std::size_t N>
+  constexpr bool
+  memory_matches_bytes()
+  {
+    for (std::size_t off = 0; off < 4; ++off)
+      {
+        unsigned char src[N + 8] = {}, dst[N + 8] = {};
+        for (std::size_t i = 0; i < N + 8; ++i)
+          {
+            src[i] = (unsigned char)(i * 37 + 1);
+            dst[i] = 0xee;
+          }
+        vir::__detail::__cw_copy<N>(dst + off, src + off);
+        for (std::size_t i = 0; i < N + 8; ++i)
+          if (dst[i] != (i >= off and i < off + N ? src[i] : 0xee))
+            return false;
+        vir::__detail::__cw_set<N>(dst + off, 0x5a);
+        for (std::size_t i = 0; i < N + 8; ++i)
+          if (dst[i] != (i >= off and i < off + N ? 0x5a : 0xee))
+            return false;
+        vir::__detail::__cw_copy<N>(dst + off, src + off);
+        if (vir::__detail::__cw_compare<N>(dst + off, src + off) != 0)
+          return false;
+        // a difference at the first, a middle, or the last position decides the result, in
+        // either direction
+        for (std::size_t i : {off, off + N / 2, off + N - 1})
+          {
+            if (N == 0)
+              break;
+            dst[i] = (unsigned char)(src[i] + 1);
+            src[i + 1] = (unsigned char)(dst[i + 1] + 1);
+            const bool greater = dst[i] > src[i];
+            if ((vir::__detail::__cw_compare<N>(dst + off, src + off) > 0) != greater
+                  or (vir::__detail::__cw_compare<N>(src + off, dst + off) > 0) == greater)
+              return false;
+            dst[i] = src[i];
+            src[i + 1] = dst[i + 1];
+          }
+      }
+    return true;
+  }
+
+// every size class: 0, powers of 2 and sizes between (up to the block size), multiples of the
+// block size and sizes between; a fixed number of sizes, independent of the target ISA
+template <std::size_t... Ns>
+  constexpr bool
+  memory_matches_bytes_for()
+  { return (memory_matches_bytes<Ns>() and ...); }
+
+constexpr std::size_t mem_block = vir::__detail::__cw_mem_block;
+
+static_assert(memory_matches_bytes_for<0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                       mem_block - 1, mem_block, mem_block + 1,
+                                       2 * mem_block - 1, 2 * mem_block + 1,
+                                       3 * mem_block, 3 * mem_block + 1>());
+
+void
+test_memory(char* dst, const char* src, std::size_t n)
+{
+  check<void*>(vir::cw_memcpy(dst, src, std::cw<12>));
+  check<void*>(vir::cw_memcpy(dst, src, std::cw<24uz>));
+  check<void*>(vir::cw_memcpy(dst, src, std::cw<4096>));
+  check<void*>(vir::cw_memcpy(dst, src, n));
+  check<void*>(vir::cw_memset(dst, 0, std::cw<0>));
+  check<void*>(vir::cw_memset(dst, 0, std::cw<13>));
+  check<void*>(vir::cw_memset(dst, 0, n));
+  check<int>(vir::cw_memcmp(dst, src, std::cw<1>));
+  check<int>(vir::cw_memcmp(dst, src, std::cw<12>));
+  check<int>(vir::cw_memcmp(dst, src, std::cw<100>));
+  check<int>(vir::cw_memcmp(dst, src, n));
+  static_assert(not [](auto size) {
+    return requires(char* p) { vir::cw_memcpy(p, p, size); };
+  }(std::cw<-1>));
+  static_assert(not [](auto size) {
+    return requires(char* p) { vir::cw_memcmp(p, p, size); };
+  }(std::cw<-1>));
+}
+
+template <std::size_t N>
+  constexpr vir::mat<int, N, N>
+  iota_mat()
+  {
+    vir::mat<int, N, N> m = {};
+    for (std::size_t i = 0; i < N; ++i)
+      for (std::size_t j = 0; j < N; ++j)
+        m(i, j) = int(i * N + j);
+    return m;
+  }
+
+void
+test_linalg()
+{
+  constexpr vir::mat<int, 2, 3> a = {{{1, 2, 3}, {4, 5, 6}}};
+  constexpr vir::mat<int, 3, 2> b = {{{7, 8}, {9, 10}, {11, 12}}};
+  constexpr vir::mat<int, 2, 2> ab = {{{58, 64}, {139, 154}}};
+  static_assert(a * b == ab);
+  static_assert(transpose(a) == vir::mat<int, 3, 2>{{{1, 4}, {2, 5}, {3, 6}}});
+  static_assert(a * vir::vec<int, 3>{1, 0, 2} == vir::vec<int, 2>{7, 16});
+  static_assert(dot(vir::vec<int, 3>{1, 2, 3}, vir::vec<int, 3>{4, 5, 6}) == 32);
+  static_assert(2 * vir::vec<int, 2>{1, 2} + vir::vec<int, 2>{1, 1} == vir::vec<int, 2>{3, 5});
+  check<vir::mat<float, 3, 4>>(vir::make_mat<float>(std::cw<3>, std::cw<4>));
+  check<vir::vec<double, 6>>(vir::make_vec<double>(std::cw<6>));
+  check<3uz>(vir::make_mat<float>(std::cw<3>, std::cw<4>).rows);
+  static_assert(iota_mat<4>() * vir::identity<int>(std::cw<4>) == iota_mat<4>());
+  // blocked kernels
+  static_assert(iota_mat<40>() * vir::identity<int>(std::cw<40>) == iota_mat<40>());
+  static_assert(transpose(transpose(iota_mat<40>())) == iota_mat<40>());
+  static_assert((iota_mat<9>() * iota_mat<9>())(8, 8) == 30636);
+  // via the constexpr_wrapper operators
+  check<ab>(std::cw<a> * std::cw<b>);
+}
+
+void
+test_units()
+{
+  using namespace vir::units;
+  constexpr auto d = 2.5 * kilometre;
+  check<quantity<kilometre_t, double>>(d);
+  static_assert(quantity<metre_t>(d).count() == 2500.);
+  static_assert(quantity_cast<millimetre_t>(1 * metre).count() == 1000);
+  // integral values: exact multiply / divide
+  static_assert(quantity_cast<metre_t>(3 * kilometre).count() == 3000);
+  static_assert(quantity_cast<minute_t>(7200 * second).count() == 120);
+  static_assert(std::is_convertible_v<quantity<hour_t, int>, quantity<second_t, int>>);
+  static_assert(not std::is_convertible_v<quantity<second_t, int>, quantity<hour_t, int>>);
+  static_assert(not std::is_constructible_v<quantity<second_t>, quantity<metre_t>>);
+  // scales combine at compile time
+  check<vir::ratio(1)>(decltype(kilometre * millimetre)::scale());
+  check<vir::ratio(5, 18)>(kilometre_per_hour_t::scale());
+  static_assert(quantity_cast<second_t>(quantity<millisecond_t, int>(4500)).count() == 4);
+  static_assert(quantity<millisecond_t, int>(quantity<second_t, int>(3)).count() == 3000);
+  static_assert(decltype(metre / second)::dim == dimensions::length / dimensions::time);
+  constexpr auto v = (36. * kilometre) / (1. * hour);
+  static_assert(quantity<metre_per_second_t>(v).count() == 10.);
+  static_assert((2 * metre) * (3 * metre) == 6 * decltype(metre * metre)());
+  static_assert(1 * metre + 2 * metre == 3 * metre);
+  static_assert(1 * metre < 2 * metre);
+}
+
+void
+test_ratio()
+{
+  using vir::ratio;
+  static_assert(ratio(2, 4) == ratio(1, 2));
+  static_assert(ratio(1, -2) == ratio(-1, 2));
+  static_assert(ratio(-1, 2).den == 2);
+  static_assert(ratio(1, 3) < ratio(1, 2));
+  static_assert(ratio(441, 480) * ratio(480, 441) == 1);
+  static_assert(ratio(1, 3) - ratio(1, 3) == ratio());
+  static_assert(ratio(0, 5) * ratio(3, 7) == 0);
+  static_assert(double(ratio(1, 4)) == .25);
+  static_assert(float(ratio(441, 480)) == 441.f / 480.f);
+  static_assert(ratio(1, 3).to_fixed(15) == 10923);
+  static_assert(ratio(-1, 3).to_fixed(15) == -10923);
+  // through the constexpr_wrapper operators
+  check<ratio(1, 2)>(std::cw<ratio(1, 3)> + std::cw<ratio(1, 6)>);
+  check<ratio(441, 240)>(std::cw<ratio(441, 480)> * std::cw<2>);
+  check<ratio(3, 2)>(std::cw<ratio(1, 2)> / std::cw<ratio(1, 3)>);
+  check<true>(std::cw<ratio(1, 3)> < std::cw<ratio(1, 2)>);
+  check<ratio(-1, 2)>(-std::cw<ratio(1, 2)>);
+  // scaling
+  static_assert(vir::scale(480, std::cw<ratio(441, 480)>) == 441);
+  static_assert(vir::scale(2'000'000'000, std::cw<ratio(3, 4)>) == 1'500'000'000);
+  static_assert(vir::scale(1.f, std::cw<ratio(1, 4)>) == .25f);
+  check<short>(vir::scale(short(1), std::cw<ratio(1, 4)>));
+  // the intermediate of 64-bit integers is 128 bits wide
+  static_assert(vir::scale(std::int64_t(6'000'000'000'000'000'000), std::cw<ratio(2, 3)>)
+                  == 4'000'000'000'000'000'000);
+  static_assert(vir::scale(~std::uint64_t(), std::cw<ratio(1, 3)>) == ~std::uint64_t() / 3);
+  static_assert(vir::scale(-9, std::cw<ratio(-1, 2)>) == 4);
+  static_assert(not [](auto r) { return requires { vir::scale(10u, r); }; }(std::cw<ratio(-1, 2)>));
+}
+
+// records the number of operations (of the expression tree, i.e. a shared subexpression counts
+// once per use) and the length of the dependency chain
+struct op_counter
+{
+  using value_type = double;
+
+  double value = 0;
+  int muls = 0;
+  int adds = 0;
+  int negs = 0;
+  int depth = 0;
+
+  constexpr
+  op_counter(double x)
+  : value(x)
+  {}
+
+  constexpr
+  op_counter(double x, int m, int a, int n, int d)
+  : value(x), muls(m), adds(a), negs(n), depth(d)
+  {}
+
+  friend constexpr op_counter
+  operator*(op_counter a, op_counter b)
+  {
+    return {a.value * b.value, a.muls + b.muls + 1, a.adds + b.adds, a.negs + b.negs,
+            std::max(a.depth, b.depth) + 1};
+  }
+
+  friend constexpr op_counter
+  operator+(op_counter a, op_counter b)
+  {
+    return {a.value + b.value, a.muls + b.muls, a.adds + b.adds + 1, a.negs + b.negs,
+            std::max(a.depth, b.depth) + 1};
+  }
+
+  constexpr op_counter
+  operator-() const
+  { return {-value, muls, adds, negs + 1, depth + 1}; }
+};
+
+void
+test_polynomial()
+{
+  using std::cw;
+  static_assert(vir::polyval(2, cw<1>, cw<2>, cw<3>) == 1 + 2 * 2 + 3 * 4);
+  static_assert(vir::polyval(2., cw<1.>, cw<-1.>, cw<.5>, cw<0.>) == 1.);
+  static_assert(vir::polyval(3, cw<5>) == 5);
+  static_assert(vir::polyval(3, cw<0>, cw<0>) == 0);
+  static_assert(vir::polyval(2, cw<1>, cw<1>, cw<1>, cw<1>, cw<1>, cw<1>, cw<1>, cw<1>) == 255);
+  static_assert(vir::polyval_horner(-2, cw<3>, cw<0>, cw<1>, cw<-1>, cw<2>) == 47);
+  static_assert(vir::polyval_estrin(-2, cw<3>, cw<0>, cw<1>, cw<-1>, cw<2>) == 47);
+  static_assert(vir::polyval(.5f, cw<vir::ratio(1, 2)>, cw<vir::ratio(1, 4)>) == .625f);
+
+  constexpr op_counter x = 2.;
+  // dense degree 3: Horner, 3 muls + 3 adds
+  constexpr auto p3 = vir::polyval(x, cw<1.>, cw<2.>, cw<3.>, cw<4.>);
+  static_assert(p3.value == 49. and p3.muls == 3 and p3.adds == 3 and p3.depth == 6);
+  // dense degree 7: Estrin, the dependency chain is shorter than Horner's
+  constexpr auto p7 = vir::polyval(x, cw<1.>, cw<2.>, cw<3.>, cw<4.>, cw<5.>, cw<6.>, cw<7.>,
+                                   cw<8.>);
+  constexpr auto h7 = vir::polyval_horner(x, cw<1.>, cw<2.>, cw<3.>, cw<4.>, cw<5.>, cw<6.>,
+                                          cw<7.>, cw<8.>);
+  static_assert(p7.value == h7.value and h7.depth == 14 and p7.depth < 10);
+  // ±1 coefficients need no multiply: 1 - x + x²
+  constexpr auto pm = vir::polyval(x, cw<1.>, cw<-1.>, cw<1.>);
+  static_assert(pm.value == 3. and pm.muls == 1 and pm.adds == 2);
+  // odd polynomial (sin-like): x (c1 + x² (c3 + x² c5))
+  constexpr auto po = vir::polyval(x, cw<0.>, cw<1.>, cw<0.>, cw<-1. / 6>, cw<0.>, cw<1. / 120>);
+  constexpr auto ho = vir::polyval_horner(x, cw<0.>, cw<1.>, cw<0.>, cw<-1. / 6>, cw<0.>,
+                                          cw<1. / 120>);
+  static_assert(po.value == ho.value and po.adds == 2 and po.depth < ho.depth);
+  // trailing zeros reduce the degree
+  constexpr auto pz = vir::polyval(x, cw<1.>, cw<2.>, cw<0.>, cw<0.>, cw<0.>);
+  static_assert(pz.value == 5. and pz.muls == 1 and pz.adds == 1);
+}
+
+// counts the multiplications of a DAG, i.e. a reused result does not count again
+struct mul_counter
+{
+  unsigned long long exponent;
+  int* count;
+
+  friend constexpr mul_counter
+  operator*(mul_counter a, mul_counter b)
+  {
+    ++*a.count;
+    return {a.exponent + b.exponent, a.count};
+  }
+};
+
+template <int N>
+  constexpr int pow_muls = [] {
+    int n = 0;
+    return vir::pow(mul_counter{1, &n}, std::cw<N>).exponent == N ? n : -1;
+  }();
+
+void
+test_math()
+{
+  using std::cw;
+  static_assert(vir::pow(3, cw<5>) == 243);
+  static_assert(vir::pow(2u, cw<31>) == 1u << 31);
+  static_assert(vir::pow(1.5, cw<0>) == 1.);
+  static_assert(vir::pow(2., cw<-2>) == .25);
+  static_assert(vir::pow(3ull, cw<40>) == 12157665459056928801ull);
+  static_assert(vir::pow(1u, cw<100000>) == 1u); // binary method
+  // shortest addition chains
+  static_assert(pow_muls<1> == 0);
+  static_assert(pow_muls<5> == 3);
+  static_assert(pow_muls<7> == 4);
+  static_assert(pow_muls<15> == 5);
+  static_assert(pow_muls<127> == 10);
+  static_assert(pow_muls<1025> == 11); // binary method
+  // constants
+  check<1024>(vir::pow(cw<2>, cw<10>));
+  check<.125>(vir::pow(cw<2.>, cw<-3>));
+  check<vir::ratio(1, 8)>(vir::pow(cw<vir::ratio(1, 2)>, cw<3>));
+  check<12>(vir::sqrt(cw<168>));
+  check<13>(vir::sqrt(cw<169>));
+  check<0xffff'ffffull>(vir::sqrt(cw<~0ull>));
+  check<10>(vir::log2(cw<1024>));
+  check<10>(vir::log2(cw<2047u>));
+  check<8>(vir::popcount(cw<0xff>));
+  check<32>(vir::popcount(cw<-1>));
+  check<3>(vir::bit_width(cw<5u>));
+  check<0>(vir::bit_width(cw<0>));
+}
+
+// a wide-integer type without (i.e. with slow) division, and without multiplication by int
+template <typename T>
+  struct wide
+  {
+    T value;
+
+    constexpr
+    wide(T x)
+    : value(x)
+    {}
+
+    friend constexpr wide
+    operator<<(wide a, int k)
+    { return a.value << k; }
+
+    friend constexpr wide
+    operator>>(wide a, int k)
+    { return a.value >> k; }
+
+    friend constexpr wide
+    operator&(wide a, wide b)
+    { return a.value & b.value; }
+
+    friend constexpr wide
+    operator+(wide a, wide b)
+    { return a.value + b.value; }
+
+    friend constexpr wide
+    operator-(wide a, wide b)
+    { return a.value - b.value; }
+
+    friend constexpr bool
+    operator<(wide a, wide b)
+    { return a.value < b.value; }
+
+    friend constexpr bool
+    operator==(wide, wide) = default;
+
+    friend wide
+    operator/(wide, wide) = delete;
+
+    friend wide
+    operator%(wide, wide) = delete;
+  };
+
+template <auto D, typename T>
+  constexpr bool
+  pow2_matches_builtin(T lo, T hi)
+  {
+    for (T x = lo; x <= hi; ++x)
+      if (x * std::cw<D> != x * D or x / std::cw<D> != x / D or x % std::cw<D> != x % D)
+        return false;
+    return true;
+  }
+
+template <typename T, auto D>
+  concept divisible_by = requires(T x) { x / D; };
+
+void
+test_pow2()
+{
+  using std::cw;
+  static_assert(pow2_matches_builtin<8>(-100, 100));
+  static_assert(pow2_matches_builtin<1>(-10, 10));
+  static_assert(pow2_matches_builtin<16u>(0u, 100u));
+  static_assert(pow2_matches_builtin<4>(short(-20), short(20)));
+  static_assert(pow2_matches_builtin<1024>(-1100, 1100));
+  // result types follow the usual arithmetic conversions
+  check<int>(short(1) * cw<8>);
+  check<long>(1 * cw<8L>);
+  check<unsigned>(-1 / cw<2u>);
+  static_assert(-1 / cw<2u> == 0x7fff'ffffu);
+  check<int>(cw<4> * 3);
+  static_assert(cw<4> * 3 == 12);
+  // not a power of two, or not an integer: built-in operators
+  check<int>(7 / cw<3>);
+  check<double>(1. / cw<4>);
+  // wide integers, without division
+  using i128 = wide<__int128>;
+  using u128 = wide<unsigned __int128>;
+  static_assert(i128(-4097) / cw<4096> == -1);
+  static_assert(i128(-4097) % cw<4096> == -1);
+  static_assert(i128(-4096) % cw<4096> == 0);
+  static_assert(i128(8191) / cw<4096> == 1);
+  static_assert(i128(-3) * cw<8> == -24);
+  static_assert(u128(12345) % cw<4096> == 12345 % 4096);
+  static_assert(u128(~0ull) * cw<2> == (unsigned __int128)(~0ull) * 2);
+  static_assert(cw<1024> * u128(1) == 1024u);
+  check<i128>(i128(1) % cw<4096>);
+  static_assert(not divisible_by<i128, cw<3>>);
+}
+
+// instantiating the call operator is an error
+inline constexpr auto not_instantiated = []<typename T = void>() {
+  static_assert(std::same_as<T, int>);
+  return 0;
+};
+
+constexpr int
+cw_if_runtime(bool c)
+{
+  int n = 0;
+  vir::cw_if(c, [&] { n = 1; });
+  return vir::cw_if(c, [] { return 2; }, [] { return short(3); }) + n;
+}
+
+void
+test_select()
+{
+  using std::cw;
+  check<int>(vir::cw_if(cw<1> < cw<2>, [] { return 1; }, not_instantiated));
+  check<const char*>(vir::cw_if(cw<1> > cw<2>, not_instantiated, [] { return "else"; }));
+  check<double>(vir::cw_if(true, [] { return 1; }, [] { return 2.; }));
+  vir::cw_if(cw<false>, not_instantiated);
+  static_assert(cw_if_runtime(true) == 3);
+  static_assert(cw_if_runtime(false) == 3);
+  // select
+  check<int>(vir::select(cw<true>, 1, "no"));
+  check<float>(vir::select(cw<true> and cw<false>, 1, 2.f));
+  check<long>(vir::select(false, 1, 2L));
+  static_assert(vir::select(true, 1, 2L) == 1);
+  static_assert(vir::select(false, -1, 2u) == 2u);
+  static_assert(vir::select(true, short(-5), short(7)) == -5);
+  static_assert(vir::select(false, 1.5, 2.5) == 2.5);
+}
+
+template <std::constexpr_value Table>
+  constexpr bool
+  lower_bound_matches(Table table, int lo, int hi)
+  {
+    for (int key = lo; key <= hi; ++key)
+      if (vir::lower_bound(table, key)
+            != std::size_t(std::lower_bound(table.value.begin(), table.value.end(), key)
+                             - table.value.begin()))
+        return false;
+    return true;
+  }
+
+template <typename Table>
+  concept searchable = requires(Table t) { vir::lower_bound(t, 1); };
+
+void
+test_sort()
+{
+  using std::cw;
+  // std::array's operator== is a template, so it does not consider the conversion
+  check<std::constexpr_wrapper<std::array{1, 2, 3}>>(vir::sort(cw<3>, cw<1>, cw<2>));
+  check<std::constexpr_wrapper<std::array{-1L, 2L, 2L, 5L}>>(
+    vir::sort(cw<2>, cw<5L>, cw<2>, cw<-1>));
+  check<std::constexpr_wrapper<std::array{.5}>>(vir::sort(cw<.5>));
+  constexpr auto table = vir::sort(cw<40>, cw<10>, cw<30>, cw<20>, cw<50>, cw<60>, cw<70>);
+  check<2uz>(vir::sorted_index_of(cw<30>, table));
+  check<0uz>(vir::sorted_index_of(cw<-5>, table));
+  check<3uz>(vir::sorted_index_of(cw<31>, table));
+  check<7uz>(vir::sorted_index_of(cw<71>, table));
+  static_assert(lower_bound_matches(table, 0, 80));
+  static_assert(lower_bound_matches(vir::sort(cw<1>), 0, 2));
+  static_assert(lower_bound_matches(cw<std::array{1, 1, 2, 3, 5, 8, 13, 21, 34, 55}>, 0, 60));
+  static_assert(not searchable<decltype(cw<std::array{2, 1}>)>);
+}
+
+// 0-1 principle: a comparator network sorts all inputs iff it sorts all inputs of 0s and 1s.
+// Bit b of wire i is bit i of input b, so that a comparator is an AND (min) and an OR (max) for
+// all 2^N inputs.
+template <std::size_t N>
+  constexpr bool
+  network_sorts_all_01_inputs()
+  {
+    constexpr auto& net = vir::__detail::__network<N>;
+    constexpr std::size_t words = ((1u << N) + 63) / 64;
+    std::array<std::array<unsigned long long, words>, N> wire = {};
+    for (unsigned b = 0; b < (1u << N); ++b)
+      for (std::size_t i = 0; i < N; ++i)
+        wire[i][b / 64] |= ((b >> i) & 1ull) << (b % 64);
+    for (std::size_t c = 0; c < net._M_size; ++c)
+      for (std::size_t k = 0; k < words; ++k)
+        {
+          auto& lo = wire[net._M_cmp[c]._M_i][k];
+          auto& hi = wire[net._M_cmp[c]._M_j][k];
+          const auto min = lo & hi;
+          hi |= lo;
+          lo = min;
+        }
+    for (std::size_t i = 0; i + 1 < N; ++i)
+      for (std::size_t k = 0; k < words; ++k)
+        if (wire[i][k] & ~wire[i + 1][k])
+          return false;
+    return true;
+  }
+
+template <typename N>
+  constexpr bool
+  sorts_permutations(N n)
+  {
+    for (unsigned seed = 1; seed < 20; ++seed)
+      {
+        std::array<unsigned, 40> a = {};
+        for (std::size_t i = 0; i < n; ++i)
+          a[i] = (seed * 2654435761u * (i + 1)) >> 7;
+        vir::sort(a, n);
+        if (not std::is_sorted(a.begin(), a.begin() + n))
+          return false;
+      }
+    return true;
+  }
+
+void
+test_sorting_network(float* x, std::size_t n)
+{
+  using std::cw;
+  static_assert([]<std::size_t... Ns>(std::index_sequence<Ns...>) {
+    return (network_sorts_all_01_inputs<Ns + 2>() and ...);
+  }(std::make_index_sequence<9>()));
+  static_assert(vir::__detail::__network<5>._M_size == 9);
+  static_assert(vir::__detail::__network<9>._M_size == 25);
+  static_assert(vir::__detail::__network<10>._M_size == 29);
+  static_assert(sorts_permutations(cw<0uz>));
+  static_assert(sorts_permutations(cw<1uz>));
+  static_assert(sorts_permutations(cw<25uz>));
+  static_assert(sorts_permutations(cw<32uz>));
+  static_assert(sorts_permutations(cw<40uz>));
+  static_assert(sorts_permutations(7uz));
+  static_assert(sorts_permutations(40uz));
+  vir::sort(std::span(x, 9), cw<9>);
+  vir::sort(std::span(x, n), n);
+}
+
+template <typename N, typename... K>
+  constexpr bool
+  reduces_iota(N n, K... k)
+  {
+    std::array<int, 300> a = {};
+    std::array<double, 300> b = {};
+    for (std::size_t i = 0; i < a.size(); ++i)
+      {
+        a[i] = int(i + 1) * (i % 2 ? 1 : -1);
+        b[i] = 0.5 * double(i + 1);
+      }
+    const int m = int(n);
+    const int sum = m % 2 ? -(m + 1) / 2 : m / 2;
+    const int min = m % 2 ? -m : 1 - m;
+    const int max = m == 1 ? -1 : m % 2 ? m - 1 : m;
+    const double squares = double(m) * (m + 1) * (2 * m + 1) / 6;
+    return vir::sum(a, n, k...) == sum and vir::min(a, n, k...) == min
+             and vir::max(a, n, k...) == max and vir::dot(b, b, n, k...) == squares / 4
+             and vir::reduce(b, n, std::plus<>(), k...) == double(m) * (m + 1) / 4;
+  }
+
+float
+test_reduce(std::span<const float> x, std::size_t n)
+{
+  using std::cw;
+  static_assert(reduces_iota(cw<1uz>));
+  static_assert(reduces_iota(cw<7uz>));
+  static_assert(reduces_iota(cw<64uz>));
+  static_assert(reduces_iota(cw<67uz>));
+  static_assert(reduces_iota(cw<300uz>));
+  static_assert(reduces_iota(cw<67uz>, cw<3uz>));
+  static_assert(reduces_iota(cw<300uz>, cw<7uz>));
+  static_assert(reduces_iota(1uz));
+  static_assert(reduces_iota(5uz));
+  static_assert(reduces_iota(299uz));
+  static_assert(reduces_iota(299uz, cw<5uz>));
+  check<float>(vir::sum(x, cw<64uz>));
+  check<double>(vir::dot(x, std::array<double, 8>(), cw<8uz>));
+  return vir::sum(x, n, cw<8uz>) + vir::max(x, n) + vir::reduce(x, n, std::multiplies<>());
+}
+
+template <auto K>
+  constexpr bool
+  stencil_matches_naive()
+  {
+    constexpr std::size_t h = K.size(), w = K[0].size(), width = 9, height = 7;
+    std::array<int, width * height> in = {};
+    for (std::size_t i = 0; i < in.size(); ++i)
+      in[i] = int((i * 37 + 11) % 23) - 7;
+    std::array<int, width * height> out = {};
+    vir::stencil(in, out, width, std::cw<K>);
+    for (std::size_t y = h / 2; y + h / 2 < height; ++y)
+      for (std::size_t x = w / 2; x + w / 2 < width; ++x)
+        {
+          int sum = 0;
+          for (std::size_t i = 0; i < h; ++i)
+            for (std::size_t j = 0; j < w; ++j)
+              sum += K[i][j] * in[(y + i - h / 2) * width + x + j - w / 2];
+          if (out[y * width + x] != sum)
+            return false;
+        }
+    return true;
+  }
+
+void
+test_stencil(std::span<const unsigned char> img, std::span<unsigned char> out, std::size_t w)
+{
+  using std::cw;
+  using A3 = std::array<int, 3>;
+  constexpr std::array<A3, 3> binomial = {A3{1, 2, 1}, A3{2, 4, 2}, A3{1, 2, 1}};
+  constexpr std::array<A3, 3> sobel_x = {A3{-1, 0, 1}, A3{-2, 0, 2}, A3{-1, 0, 1}};
+  constexpr std::array<A3, 3> negative = {A3{0, -3, 0}, A3{-3, -5, -3}, A3{0, -3, 0}};
+  constexpr std::array<std::array<int, 5>, 3> wide
+    = {{{1, 0, 3, 0, 1}, {-2, 7, 0, 7, 2}, {0, 0, 0, 0, -1}}};
+  static_assert(vir::__detail::__stencil_plan_for<decltype(cw<binomial>)>._M_groups == 3);
+  static_assert(vir::__detail::__stencil_plan_for<decltype(cw<sobel_x>)>._M_groups == 2);
+  static_assert(vir::__detail::__stencil_plan_for<decltype(cw<sobel_x>)>._M_taps == 6);
+  static_assert(stencil_matches_naive<binomial>());
+  static_assert(stencil_matches_naive<sobel_x>());
+  static_assert(stencil_matches_naive<negative>());
+  static_assert(stencil_matches_naive<wide>());
+  static_assert(stencil_matches_naive<std::array<std::array<int, 1>, 1>{}>());
+  static_assert(vir::stencil_at(cw<std::array{-1, 0, 1}>, [](auto dx) { return 10 * dx; }) == 20);
+  static_assert(vir::stencil_at(cw<std::array{.25, .5, .25}>, [](auto dx) {
+                  return double(dx * dx);
+                }) == .5);
+  static_assert([] {
+    std::array<float, 6> x = {1, 2, 4, 8, 16, 32};
+    std::array<float, 6> y = {};
+    vir::stencil(x, y, cw<std::array{.25f, .5f, .25f}>);
+    return y == std::array<float, 6>{0, 2.25f, 4.5f, 9, 18, 0};
+  }());
+  check<int>(vir::stencil_at(cw<binomial>, [&](auto dy, auto dx) { return img[dy + dx]; }));
+  vir::stencil(img, out, w, cw<binomial>, [](int s) { return s / cw<16>; });
+}
+
+bool
+test_bitset(const vir::bitset<40>& perms, const vir::bitset<1000>& big)
+{
+  using std::cw;
+  constexpr auto read = vir::make_bitset(cw<40uz>, cw<0>, cw<1>);
+  constexpr auto write = vir::make_bitset(cw<40uz>, cw<1>, cw<39>);
+  check<std::constexpr_wrapper<vir::bitset<40>{{0b11}}>>(read);
+  check<std::constexpr_wrapper<vir::bitset<40>{{0b10}}>>(read & write);
+  check<std::constexpr_wrapper<vir::bitset<40>{{0b11 | 1ull << 39}}>>(read | write);
+  check<std::constexpr_wrapper<vir::bitset<40>{{0b01 | 1ull << 39}}>>(read ^ write);
+  check<std::constexpr_wrapper<vir::bitset<40>{{0xff'ffff'fffcull}}>>(~read);
+  check<true>(read[cw<1>]);
+  check<false>(read[cw<2>]);
+  check<2>(vir::popcount(read));
+  check<1uz>(vir::find_first(read & write));
+  check<40uz>(vir::find_first(vir::make_bitset(cw<40uz>)));
+  check<true>(vir::intersects(read, write));
+  check<false>(vir::is_subset_of(read, write));
+  check<true>(vir::is_subset_of(read & write, write));
+  static_assert([] {
+    vir::bitset<200> b = vir::make_bitset(cw<200uz>, 3uz, 64uz, 199uz);
+    return b.count() == 3 and b.find_first() == 3 and b.find_next(4) == 64
+             and b.find_next(65) == 199 and b.find_next(200) == 200 and not b.all()
+             and (~vir::bitset<200>()).all() and (~vir::bitset<200>()).count() == 200
+             and not b.reset(3).reset(64).flip(199).any() and vir::bitset<0>().none();
+  }());
+  // the single word of an empty bitset has no valid bits
+  static_assert((~vir::bitset<0>()).count() == 0 and (~vir::bitset<0>()).none()
+                  and vir::bitset<0>().all() and (~vir::bitset<0>()).find_first() == 0);
+  check<0>(vir::popcount(~vir::make_bitset(cw<0uz>)));
+  check<bool>(vir::intersects(perms, read));
+  check<int>(big.count());
+  return vir::is_subset_of(write, perms) and big.find_first() < 1000;
+}
+
+namespace enum_test
+{
+  enum class msg : short { hello = -2, data, ack, bye = 2 };
+  enum color { red, green, blue };
+  enum class wide : unsigned { first = 0, last = 299 };
+}
+
+template <>
+  struct vir::enum_bounds<enum_test::msg>
+  {
+    static constexpr enum_test::msg min = enum_test::msg::hello;
+    static constexpr enum_test::msg max = enum_test::msg::bye;
+  };
+
+template <>
+  struct vir::enum_bounds<enum_test::color>
+  {
+    static constexpr enum_test::color min = enum_test::red;
+    static constexpr enum_test::color max = enum_test::blue;
+  };
+
+template <>
+  struct vir::enum_bounds<enum_test::wide>
+  {
+    static constexpr enum_test::wide min = enum_test::wide::first;
+    static constexpr enum_test::wide max = enum_test::wide::last;
+  };
+
+int
+test_enum(enum_test::msg m, enum_test::wide w, std::size_t i)
+{
+  using std::cw;
+  using enum enum_test::msg;
+  static_assert(not vir::bounded_enum<int>);
+  static_assert(not vir::bounded_enum<std::byte>);
+  check<5uz>(vir::enum_size<enum_test::msg>);
+  check<300uz>(vir::enum_size<enum_test::wide>);
+  check<1uz>(vir::enum_index(cw<data>));
+  static_assert(vir::enum_index(bye) == 4);
+  static_assert(vir::enum_name(hello) == "hello");
+  static_assert(vir::enum_name(ack) == "ack");
+  static_assert(vir::enum_name(enum_test::msg(1)).empty());
+  static_assert(vir::enum_name(bye) == "bye");
+  static_assert(vir::enum_name(enum_test::msg(3)).empty());
+  static_assert(vir::enum_name(cw<enum_test::blue>) == "blue");
+  static_assert(vir::enum_name(enum_test::wide::last) == "last");
+  static_assert(vir::enum_name(enum_test::wide(150)).empty());
+  static_assert(vir::enum_name(bye).data()[3] == '\0');
+  static_assert([] {
+    for (short v = -2; v <= 2; ++v)
+      if (vir::enum_dispatch(enum_test::msg(v), [](auto c) {
+            static_assert(std::constexpr_value<decltype(c)>);
+            return int(c.value);
+          }) != v)
+        return false;
+    return true;
+  }());
+  check<std::string_view>(vir::enum_dispatch(cw<ack>, [](auto) { return std::string_view(); }));
+  static_assert(vir::dispatch(2uz, cw<3uz>, [](auto j) { return j * j; }) == 4);
+  check<std::constexpr_wrapper<4uz>>(vir::dispatch(cw<2uz>, cw<3uz>, [](auto j) { return j * j; }));
+  return vir::enum_dispatch(m, [](auto c) { return vir::enum_name(c).size(); })
+           + vir::enum_dispatch(w, [](auto c) { return int(vir::enum_index(c)); })
+           + vir::dispatch(i, cw<4uz>, [](auto j) { return j * cw<2uz>; });
+}
+
+template <std::size_t I>
+  struct alt
+  { int value = int(I); };
+
+constexpr bool
+multi_visit_passes_all_indices()
+{
+  using V3 = std::variant<alt<0>, alt<1>, alt<2>>;
+  using V2 = std::variant<int, alt<1>>;
+  using V4 = std::variant<alt<0>, alt<1>, alt<2>, alt<3>>;
+  constexpr V3 all3[] = {alt<0>(), alt<1>(), alt<2>()};
+  constexpr V2 all2[] = {0, alt<1>()};
+  constexpr V4 all4[] = {alt<0>(), alt<1>(), alt<2>(), alt<3>()};
+  for (const V3& a : all3)
+    for (const V2& b : all2)
+      for (const V4& c : all4)
+        {
+          const int r = vir::visit([](const auto& x, const auto& y, const auto& z, auto i, auto j,
+                                      auto k) {
+                          static_assert(std::same_as<std::remove_cvref_t<decltype(x)>,
+                                                     std::variant_alternative_t<i, V3>>);
+                          static_assert(std::same_as<std::remove_cvref_t<decltype(y)>,
+                                                     std::variant_alternative_t<j, V2>>);
+                          static_assert(std::same_as<std::remove_cvref_t<decltype(z)>,
+                                                     std::variant_alternative_t<k, V4>>);
+                          return x.value * 100 + int(j) * 10 + z.value + 0 * sizeof(y);
+                        }, a, b, c);
+          if (r != int(a.index() * 100 + b.index() * 10 + c.index()))
+            return false;
+        }
+  return true;
+}
+
+int
+test_variant(const std::variant<int, float, std::string>& v,
+             std::variant<alt<0>, alt<1>, alt<2>>& w)
+{
+  using std::cw;
+  static_assert(multi_visit_passes_all_indices());
+  static_assert(vir::visit([](auto x, auto i) { return x.value + int(i); },
+                           std::variant<alt<0>, alt<1>, alt<2>>(alt<2>())) == 4);
+  static_assert(vir::visit([](auto x, auto) { return x; }, std::variant<short, int>(1))
+                  == 1);
+  check<int>(vir::visit([](auto x, auto) { return x; }, std::variant<short, int>(1)));
+  vir::visit([](auto& x, auto) { ++x.value; }, w);
+  return vir::visit([](const auto& x, auto i) {
+           if constexpr (i == 2)
+             return int(x.size());
+           else
+             return int(x);
+         }, v);
+}
+
+template <std::size_t... Is>
+  constexpr auto
+  big_pack(std::index_sequence<Is...>)
+  { return vir::make_pack(std::cw<int(Is * 7 % 50)>...); }
+
+void
+test_pack()
+{
+  using std::cw;
+  using vir::pack;
+  constexpr auto p = vir::make_pack(cw<3>, cw<1>, cw<4>, cw<1>, cw<5>);
+  check<5uz>(p.size);
+  check<std::constexpr_wrapper<4>>(vir::at(p, cw<2uz>));
+  check<pack<std::constexpr_wrapper<6>, std::constexpr_wrapper<2>, std::constexpr_wrapper<8>,
+             std::constexpr_wrapper<2>, std::constexpr_wrapper<10>>>(
+    vir::map(p, [](auto c) { return c * cw<2>; }));
+  check<pack<std::constexpr_wrapper<3>, std::constexpr_wrapper<4>, std::constexpr_wrapper<5>>>(
+    vir::filter(p, [](auto c) { return c > cw<2>; }));
+  check<pack<>>(vir::filter(p, [](auto) { return cw<false>; }));
+  check<std::constexpr_wrapper<14>>(vir::fold(p, cw<0>, [](auto a, auto b) { return a + b; }));
+  static_assert(vir::fold(p, 0, [](int a, auto b) { return a * 10 + b; }) == 31415);
+  check<1uz>(vir::index_of(p, cw<1>));
+  check<5uz>(vir::index_of(p, cw<1u>));
+  check<true>(vir::contains(p, cw<5>));
+  check<false>(vir::contains(pack<>(), cw<5>));
+  check<pack<std::constexpr_wrapper<3>, std::constexpr_wrapper<1>, std::constexpr_wrapper<4>,
+             std::constexpr_wrapper<5>>>(vir::unique(p));
+  check<pack<>>(vir::unique(pack<>()));
+  check<pack<int, float, std::constexpr_wrapper<1>, char>>(
+    vir::concat(pack<int>(), pack<>(), pack<float, std::constexpr_wrapper<1>>(), pack<char>()));
+  check<pack<>>(vir::concat());
+  check<std::constexpr_wrapper<std::array{3, 1, 4, 1, 5}>>(vir::to_array(p));
+  // 150 elements, 50 distinct values
+  constexpr auto big = big_pack(std::make_index_sequence<150>());
+  check<50uz>(vir::unique(big).size);
+  check<25uz>(vir::filter(vir::unique(big), [](auto c) { return c % cw<2> == cw<0>; }).size);
+  check<49uz>(vir::index_of(big, cw<43>));
+}
+
+namespace memo_test
+{
+  constexpr std::array<int, 4>
+  squares(int offset)
+  { return {offset, offset + 1, offset + 4, offset + 9}; }
+
+  enum class e : signed char { a = -2, b = 7 };
+
+  constexpr std::array<std::array<e, 2>, 1>
+  enums()
+  { return {{{e::a, e::b}}}; }
+}
+
+void
+test_memo()
+{
+  using std::cw;
+  using memo_test::squares;
+  constexpr auto& s = vir::memo(cw<&squares>, cw<-3>);
+  static_assert(&s == &vir::memo_v<&squares, -3>);
+  static_assert(&s != &vir::memo_v<&squares, 3>);
+  static_assert(s[3] == 6);
+  static_assert(vir::memo(cw<[](int x) { return x * 2; }>, cw<21>) == 42);
+  static_assert(vir::memo_specialization<&squares, -3>("&memo_test::squares, -3")
+                  == "template <>\n  inline constexpr auto vir::memo_v<&memo_test::squares, -3>\n"
+                     "    = vir::__detail::__memo_result_t<&memo_test::squares, -3>"
+                     "{(-1-2), (-1-1), 1, 6};\n");
+  static_assert(vir::memo_specialization<&memo_test::enums>("&memo_test::enums").ends_with(
+                  ">{_Ep((-1-1)), _Ep(7)};\n    }();\n"));
+}
+
+constexpr bool
+tensor_for_each_matches_indexing()
+{
+  int data[2 * 3 * 4] = {};
+  auto t = vir::make_tensor_view(data, 2, std::cw<3>, 4u);
+  int k = 0;
+  vir::for_each(t, [&](int& x) { x = k++; });
+  for (int i = 0; i < 24; ++i)
+    if (data[i] != i)
+      return false;
+  // transposed 3x4 view of the first 12 elements
+  auto tr = vir::make_strided_view(data, std::tuple(std::cw<4>, 3), std::tuple(std::cw<1>, 4));
+  static_assert(tr.is_contiguous_inner == false);
+  k = 0;
+  bool ok = true;
+  vir::for_each(tr, [&](int x) { ok = ok and x == (k % 3) * 4 + k / 3; ++k; });
+  // rows padded to 5 elements, contiguous inner dimension
+  auto pad = vir::make_strided_view(data, std::tuple(4, std::cw<3>), std::tuple(5, std::cw<1>));
+  static_assert(pad.is_contiguous_inner and not pad.is_contiguous);
+  int sum = 0;
+  vir::for_each(pad, [&](int x) { sum += x; });
+  return ok and k == 12 and tr(std::cw<3>, 2) == 11 and t(1, 2, 3) == 23
+           and sum == (0 + 1 + 2) + (5 + 6 + 7) + (10 + 11 + 12) + (15 + 16 + 17);
+}
+
+void
+test_tensor(float* data, std::size_t n, std::size_t h, std::size_t w)
+{
+  using std::cw;
+  auto img = vir::make_tensor_view(data, n, cw<3>, h, w);
+  static_assert(img.rank == 4 and img.is_contiguous and img.is_contiguous_inner);
+  check<1uz>(img.stride(cw<3>));
+  check<std::size_t>(img.stride(cw<2>));
+  check<std::size_t>(img.size());
+  check<std::size_t>(img.offset(0, cw<1>, 2, 3));
+  static_assert(sizeof(img) == sizeof(float*) + 3 * sizeof(std::size_t));
+  auto fixed = vir::make_tensor_view(data, cw<2>, cw<3>, cw<4>, cw<5>);
+  static_assert(sizeof(fixed) == sizeof(float*));
+  // the same constant as extent and stride, and only one runtime value
+  auto fixed_strided
+    = vir::make_strided_view(data, std::tuple(cw<8>, cw<4>), std::tuple(cw<1>, cw<8>));
+  static_assert(sizeof(fixed_strided) == sizeof(float*));
+  check<9uz>(fixed_strided.offset(cw<1>, cw<1>));
+  auto mixed = vir::make_tensor_view(data, cw<3>, cw<4>, n);
+  static_assert(sizeof(mixed) == sizeof(float*) + sizeof(std::size_t));
+  auto mixed_strided
+    = vir::make_strided_view(data, std::tuple(cw<4>, n), std::tuple(cw<1>, cw<4>));
+  static_assert(sizeof(mixed_strided) == sizeof(float*) + sizeof(std::size_t));
+  check<120uz>(fixed.size());
+  check<20uz>(fixed.stride(cw<1>));
+  check<119uz>(fixed.offset(cw<1>, cw<2>, cw<3>, cw<4>));
+  check<std::size_t>(fixed.offset(1, cw<2>, cw<3>, cw<4>));
+  static_assert(tensor_for_each_matches_indexing());
+  vir::for_each(img, [](float& x) { x *= 0.5f; });
+}
+
+void
+test_fixed(const std::int16_t* a, const std::int16_t* b, std::int16_t* out, int n)
+{
+  using std::cw;
+  using q15 = vir::fixed<std::int16_t, 15>;
+  using q7 = vir::fixed<std::int8_t, 7>;
+  static_assert(vir::make_fixed<std::int16_t>(0.5, cw<15>).raw() == 16384);
+  static_assert(q15::from(-0.25).raw() == -8192);
+  static_assert(double(q15::from(-0.25)) == -0.25);
+  static_assert(vir::fixed<int, 8>::from(3).raw() == 768);
+  static_assert(q15::frac_bits == 15);
+  constexpr q15 half = q15::from(0.5);
+  constexpr q15 quarter = q15::from(0.25);
+  // the product is exact, with 30 fractional bits
+  check<vir::fixed<std::int32_t, 30>>(half * quarter);
+  static_assert((half * quarter).raw() == 1 << 27);
+  static_assert(vir::rescale<std::int16_t>(half * quarter, cw<15>) == q15::from(0.125));
+  static_assert(vir::rescale<std::int16_t>(q15::from(-0.75) * half, cw<15>) == q15::from(-0.375));
+  static_assert(quarter / half == half);
+  static_assert(half + quarter == q15::from(0.75) and half - quarter == quarter);
+  static_assert(half * 3 == q15::from(-0.5) * -3);
+  // mixed scales: the result has the larger number of fractional bits
+  check<vir::fixed<std::int16_t, 15>>(q7::from(0.5) + quarter);
+  static_assert(q7::from(0.5) + quarter == q15::from(0.75));
+  static_assert(q7::from(0.5) == half and q7::from(0.25) < half and half > q7::from(-0.5));
+  check<vir::fixed<std::int32_t, 22>>(q7::from(0.5) * half);
+  // unsigned: floor division of the product
+  static_assert(vir::rescale(vir::fixed<std::uint8_t, 8>::from_raw(255)
+                               * vir::fixed<std::uint8_t, 8>::from_raw(255), cw<8>).raw() == 254);
+  // constants via the constexpr_wrapper operators
+  check<vir::fixed<std::int32_t, 30>{1 << 27}>(cw<half> * cw<quarter>);
+  for (int i = 0; i < n; ++i)
+    out[i] = vir::rescale<std::int16_t>(q15::from_raw(a[i]) * q15::from_raw(b[i]), cw<15>).raw();
+}
+
+void
+test_crc(std::span<const std::byte> packet)
+{
+  constexpr std::string_view input = "123456789";
+  // the check values of the CRC catalogues
+  static_assert(vir::crc(vir::crc32, input) == 0xcbf43926);
+  static_assert(vir::crc(vir::crc32c, input) == 0xe3069283);
+  static_assert(vir::crc(vir::crc64_xz, input) == 0x995dc9bbdf1939fa);
+  static_assert(vir::crc(vir::crc64_ecma, input) == 0x6c40df5f0b497347);
+  static_assert(vir::crc(vir::crc16_ccitt, input) == 0x29b1);
+  static_assert(vir::crc(vir::crc16_arc, input) == 0xbb3d);
+  static_assert(vir::crc(vir::crc8, input) == 0xf4);
+  // CRC-16/MODBUS and CRC-5/USB: a reflected CRC with non-zero init, and a width below 8 bits
+  static_assert(vir::crc(std::cw<vir::crc_params{16, 0x8005, 0xffff, true, 0}>, input) == 0x4b37);
+  static_assert(vir::crc(std::cw<vir::crc_params{5, 0x05, 0x1f, true, 0x1f}>, input) == 0x19);
+  // CRC-12/DECT: not reflected, width not a multiple of 8
+  static_assert(vir::crc(std::cw<vir::crc_params{12, 0x80f, 0, false, 0}>, input) == 0xf5b);
+  check<std::uint32_t>(vir::crc(vir::crc32, input));
+  check<std::uint16_t>(vir::crc(vir::crc16_ccitt, input));
+  static_assert(vir::crc_engine(vir::crc32).update(input.substr(0, 4)).update(input.substr(4))
+                  .value() == 0xcbf43926);
+  // the folding constants for CRC-32 match the published ones
+  static_assert(vir::__detail::__crc_fold_constant(0x04c11db7, 4 * 128 + 32) == 0x154442bd4);
+  static_assert(vir::__detail::__crc_fold_constant(0x04c11db7, 128 - 32) == 0x0ccaa009e);
+  vir::crc_engine e(vir::crc32c);
+  e.update(packet);
+  (void)e.value();
+  (void)vir::crc(vir::crc64_xz, packet.data(), packet.size());
+}